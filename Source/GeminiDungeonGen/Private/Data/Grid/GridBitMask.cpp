@@ -0,0 +1,183 @@
+﻿// GridBitMask.cpp
+
+#include "Data/Grid/GridBitMask.h"
+
+namespace GridBitMask
+{
+	// Kogge-Stone occluded fill: spreads Gen towards higher bits through Pro in six shifts
+	static FORCEINLINE uint64 FillUp(uint64 Gen, uint64 Pro)
+	{
+		Gen |= Pro & (Gen << 1);	Pro &= (Pro << 1);
+		Gen |= Pro & (Gen << 2);	Pro &= (Pro << 2);
+		Gen |= Pro & (Gen << 4);	Pro &= (Pro << 4);
+		Gen |= Pro & (Gen << 8);	Pro &= (Pro << 8);
+		Gen |= Pro & (Gen << 16);	Pro &= (Pro << 16);
+		Gen |= Pro & (Gen << 32);
+		return Gen;
+	}
+
+	// Same as FillUp, towards lower bits
+	static FORCEINLINE uint64 FillDown(uint64 Gen, uint64 Pro)
+	{
+		Gen |= Pro & (Gen >> 1);	Pro &= (Pro >> 1);
+		Gen |= Pro & (Gen >> 2);	Pro &= (Pro >> 2);
+		Gen |= Pro & (Gen >> 4);	Pro &= (Pro >> 4);
+		Gen |= Pro & (Gen >> 8);	Pro &= (Pro >> 8);
+		Gen |= Pro & (Gen >> 16);	Pro &= (Pro >> 16);
+		Gen |= Pro & (Gen >> 32);
+		return Gen;
+	}
+}
+
+void FGridBitMask::Init(const FIntPoint& InSize, bool bValue)
+{
+	Size = FIntPoint(FMath::Max(0, InSize.X), FMath::Max(0, InSize.Y));
+	WordsPerRow = (Size.X + 63) / 64;
+	Words.Init(bValue ? ~(uint64)0 : (uint64)0, WordsPerRow * Size.Y);
+
+	// Keep padding bits past the row end cleared so fills never leak into them
+	const int32 TailBits = Size.X & 63;
+	if (bValue && TailBits != 0)
+	{
+		const uint64 TailMask = ((uint64)1 << TailBits) - 1;
+		for (int32 Y = 0; Y < Size.Y; ++Y)
+		{
+			Words[Y * WordsPerRow + WordsPerRow - 1] &= TailMask;
+		}
+	}
+}
+
+int32 FGridBitMask::CountSetBits() const
+{
+	int32 Count = 0;
+	for (const uint64 Word : Words)
+	{
+		Count += (int32)FMath::CountBits(Word);
+	}
+	return Count;
+}
+
+bool FGridBitMask::FindFirstSetBit(FIntPoint& OutCell) const
+{
+	for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+	{
+		if (Words[WordIndex] != 0)
+		{
+			const int32 Y = WordIndex / WordsPerRow;
+			const int32 X = (WordIndex % WordsPerRow) * 64 + (int32)FMath::CountTrailingZeros64(Words[WordIndex]);
+			OutCell = FIntPoint(X, Y);
+			return true;
+		}
+	}
+	return false;
+}
+
+void FGridBitMask::AndNot(const FGridBitMask& Other)
+{
+	check(Other.Words.Num() == Words.Num());
+	for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+	{
+		Words[WordIndex] &= ~Other.Words[WordIndex];
+	}
+}
+
+bool FGridBitMask::FillRow(uint64* ReachedRow, const uint64* WalkableRow, int32 NumWords)
+{
+	bool bChanged = false;
+
+	// 1. Towards higher X, carrying the top bit into the next word
+	uint64 Carry = 0;
+	for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+	{
+		const uint64 Old = ReachedRow[WordIndex];
+		const uint64 Filled = GridBitMask::FillUp((Old | Carry) & WalkableRow[WordIndex], WalkableRow[WordIndex]);
+		bChanged |= Filled != Old;
+		ReachedRow[WordIndex] = Filled;
+		Carry = Filled >> 63;
+	}
+
+	// 2. Towards lower X, carrying the bottom bit into the previous word
+	Carry = 0;
+	for (int32 WordIndex = NumWords - 1; WordIndex >= 0; --WordIndex)
+	{
+		const uint64 Old = ReachedRow[WordIndex];
+		const uint64 Filled = GridBitMask::FillDown((Old | (Carry << 63)) & WalkableRow[WordIndex], WalkableRow[WordIndex]);
+		bChanged |= Filled != Old;
+		ReachedRow[WordIndex] = Filled;
+		Carry = Filled & 1;
+	}
+
+	return bChanged;
+}
+
+void FGridBitMask::FloodFill(const FGridBitMask& Walkable, const FIntPoint& Seed, FGridBitMask& OutReached)
+{
+	OutReached.Init(Walkable.Size, false);
+	if (!Walkable.IsValidCell(Seed.X, Seed.Y) || !Walkable.Get(Seed.X, Seed.Y)) return;
+
+	const int32 NumWords = Walkable.WordsPerRow;
+	const int32 NumRows = Walkable.Size.Y;
+	uint64* Reached = OutReached.Words.GetData();
+	const uint64* Walk = Walkable.Words.GetData();
+
+	OutReached.Set(Seed.X, Seed.Y, true);
+	FillRow(Reached + Seed.Y * NumWords, Walk + Seed.Y * NumWords, NumWords);
+
+	// Spreads the neighbouring row into Row, then fills it horizontally
+	auto SpreadFrom = [NumWords, Reached, Walk](int32 Row, int32 FromRow) -> bool
+	{
+		uint64* RowWords = Reached + Row * NumWords;
+		const uint64* FromWords = Reached + FromRow * NumWords;
+		const uint64* WalkWords = Walk + Row * NumWords;
+
+		bool bSeeded = false;
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			const uint64 Spread = FromWords[WordIndex] & WalkWords[WordIndex] & ~RowWords[WordIndex];
+			if (Spread)
+			{
+				RowWords[WordIndex] |= Spread;
+				bSeeded = true;
+			}
+		}
+
+		if (bSeeded)
+		{
+			FillRow(RowWords, WalkWords, NumWords);
+		}
+		return bSeeded;
+	};
+
+	bool bChanged = true;
+	while (bChanged)
+	{
+		bChanged = false;
+
+		// Downward sweep
+		for (int32 Y = 1; Y < NumRows; ++Y)
+		{
+			bChanged |= SpreadFrom(Y, Y - 1);
+		}
+
+		// Upward sweep
+		for (int32 Y = NumRows - 2; Y >= 0; --Y)
+		{
+			bChanged |= SpreadFrom(Y, Y + 1);
+		}
+	}
+}
+
+void FGridBitMask::ForEachRegion(const FGridBitMask& Walkable, TFunctionRef<void(const FGridBitMask& Region, int32 NumCells, const FIntPoint& FirstCell)> Visitor)
+{
+	FGridBitMask Remaining = Walkable;
+	FGridBitMask Region;
+	FIntPoint Seed;
+
+	// Regions are disjoint, so flooding what is left yields the next component each time
+	while (Remaining.FindFirstSetBit(Seed))
+	{
+		FloodFill(Remaining, Seed, Region);
+		Visitor(Region, Region.CountSetBits(), Seed);
+		Remaining.AndNot(Region);
+	}
+}
@@ -0,0 +1,152 @@
+﻿// MaxRectsPacker.cpp
+
+#include "Data/Grid/MaxRectsPacker.h"
+#include "Misc/MemStack.h"
+
+namespace MaxRectsPacker
+{
+	static bool Overlaps(const FIntRect& A, const FIntRect& B)
+	{
+		return A.Min.X < B.Max.X && B.Min.X < A.Max.X && A.Min.Y < B.Max.Y && B.Min.Y < A.Max.Y;
+	}
+
+	static bool ContainsRect(const FIntRect& Outer, const FIntRect& Inner)
+	{
+		return Inner.Min.X >= Outer.Min.X && Inner.Min.Y >= Outer.Min.Y && Inner.Max.X <= Outer.Max.X && Inner.Max.Y <= Outer.Max.Y;
+	}
+}
+
+void FMaxRectsPacker::Init(const FIntPoint& InGridSize, const TBitArray<>& BlockedCells)
+{
+	GridSize = InGridSize;
+	FreeRects.Reset();
+
+	if (GridSize.X <= 0 || GridSize.Y <= 0) return;
+
+	FreeRects.Add(FIntRect(FIntPoint::ZeroValue, GridSize));
+
+	if (BlockedCells.Num() != GridSize.X * GridSize.Y) return;
+
+	// Carve blocked cells out as greedy rectangles (grow along the row, then downwards)
+	// so a block of forced cells costs one split instead of one split per cell.
+	FMemMark ScratchMark(FMemStack::Get());
+	TBitArray<TMemStackAllocator<>> Consumed(false, BlockedCells.Num());
+	for (int32 Y = 0; Y < GridSize.Y; ++Y)
+	{
+		for (int32 X = 0; X < GridSize.X; ++X)
+		{
+			const int32 Index = Y * GridSize.X + X;
+			if (!BlockedCells[Index] || Consumed[Index]) continue;
+
+			// A. Extend along the row
+			int32 EndX = X + 1;
+			while (EndX < GridSize.X && BlockedCells[Y * GridSize.X + EndX] && !Consumed[Y * GridSize.X + EndX])
+			{
+				++EndX;
+			}
+
+			// B. Extend downwards while the whole row segment is still blocked
+			int32 EndY = Y + 1;
+			for (; EndY < GridSize.Y; ++EndY)
+			{
+				bool bRowBlocked = true;
+				for (int32 RunX = X; RunX < EndX; ++RunX)
+				{
+					const int32 RunIndex = EndY * GridSize.X + RunX;
+					if (!BlockedCells[RunIndex] || Consumed[RunIndex])
+					{
+						bRowBlocked = false;
+						break;
+					}
+				}
+				if (!bRowBlocked) break;
+			}
+
+			for (int32 RunY = Y; RunY < EndY; ++RunY)
+			{
+				for (int32 RunX = X; RunX < EndX; ++RunX)
+				{
+					Consumed[RunY * GridSize.X + RunX] = true;
+				}
+			}
+
+			Occupy(FIntRect(X, Y, EndX, EndY));
+		}
+	}
+}
+
+bool FMaxRectsPacker::FindBestFit(const FIntPoint& Size, FIntRect& OutFreeRect) const
+{
+	if (Size.X <= 0 || Size.Y <= 0) return false;
+
+	bool bFound = false;
+	int32 BestShortSide = MAX_int32;
+	int32 BestLongSide = MAX_int32;
+
+	for (const FIntRect& FreeRect : FreeRects)
+	{
+		const int32 LeftoverX = FreeRect.Width() - Size.X;
+		const int32 LeftoverY = FreeRect.Height() - Size.Y;
+		if (LeftoverX < 0 || LeftoverY < 0) continue;
+
+		const int32 ShortSide = FMath::Min(LeftoverX, LeftoverY);
+		const int32 LongSide = FMath::Max(LeftoverX, LeftoverY);
+		if (ShortSide < BestShortSide || (ShortSide == BestShortSide && LongSide < BestLongSide))
+		{
+			BestShortSide = ShortSide;
+			BestLongSide = LongSide;
+			OutFreeRect = FreeRect;
+			bFound = true;
+		}
+	}
+
+	return bFound;
+}
+
+void FMaxRectsPacker::Occupy(const FIntRect& UsedRect)
+{
+	// Walk backwards so RemoveAtSwap only ever pulls in rectangles that were already handled
+	// (either an original we passed, or a split piece appended during this call).
+	for (int32 Index = FreeRects.Num() - 1; Index >= 0; --Index)
+	{
+		const FIntRect FreeRect = FreeRects[Index];
+		if (!MaxRectsPacker::Overlaps(FreeRect, UsedRect)) continue;
+
+		FreeRects.RemoveAtSwap(Index, EAllowShrinking::No);
+
+		// Up to four maximal pieces: left, right, top and bottom of the used area
+		if (UsedRect.Min.X > FreeRect.Min.X)
+		{
+			FreeRects.Add(FIntRect(FreeRect.Min.X, FreeRect.Min.Y, UsedRect.Min.X, FreeRect.Max.Y));
+		}
+		if (UsedRect.Max.X < FreeRect.Max.X)
+		{
+			FreeRects.Add(FIntRect(UsedRect.Max.X, FreeRect.Min.Y, FreeRect.Max.X, FreeRect.Max.Y));
+		}
+		if (UsedRect.Min.Y > FreeRect.Min.Y)
+		{
+			FreeRects.Add(FIntRect(FreeRect.Min.X, FreeRect.Min.Y, FreeRect.Max.X, UsedRect.Min.Y));
+		}
+		if (UsedRect.Max.Y < FreeRect.Max.Y)
+		{
+			FreeRects.Add(FIntRect(FreeRect.Min.X, UsedRect.Max.Y, FreeRect.Max.X, FreeRect.Max.Y));
+		}
+	}
+
+	PruneFreeRects();
+}
+
+void FMaxRectsPacker::PruneFreeRects()
+{
+	for (int32 Index = FreeRects.Num() - 1; Index >= 0; --Index)
+	{
+		for (int32 OtherIndex = 0; OtherIndex < FreeRects.Num(); ++OtherIndex)
+		{
+			if (OtherIndex != Index && MaxRectsPacker::ContainsRect(FreeRects[OtherIndex], FreeRects[Index]))
+			{
+				FreeRects.RemoveAtSwap(Index, EAllowShrinking::No);
+				break;
+			}
+		}
+	}
+}
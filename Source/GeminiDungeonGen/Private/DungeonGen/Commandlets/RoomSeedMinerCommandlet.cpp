@@ -0,0 +1,244 @@
+﻿// RoomSeedMinerCommandlet.cpp
+
+#include "DungeonGen/Commandlets/RoomSeedMinerCommandlet.h"
+#include "DungeonGen/Rooms/RoomLayoutSolver.h"
+#include "Data/Room/RoomData.h"
+#include "Data/Room/FloorData.h"
+#include "Data/Room/WallData.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace RoomSeedMiner
+{
+	// Metrics for one solved seed
+	struct FSeedStats
+	{
+		int32 Seed = 0;
+		float Score = 0.0f;
+		int32 FloorCells = 0;
+		float FillerRatio = 0.0f;
+		float FurnitureDensity = 0.0f;
+		int32 NumRegions = 0;
+		float LargestRegionFraction = 0.0f;
+		int32 MeshVariety = 0;
+		int32 NumPlacements = 0;
+	};
+
+	struct FScoreSettings
+	{
+		float ConnectivityWeight = 1.0f;
+		float FurnitureWeight = 1.0f;
+		float FillerWeight = 1.0f;
+		float VarietyWeight = 0.5f;
+		float MaxFillerRatio = 1.0f;
+		bool bRequireConnected = true;
+		int32 PoolMeshCount = 1;
+	};
+
+	static void ComputeStats(const FRoomLayout& Layout, FGridBitMask& Walkable, FSeedStats& OutStats)
+	{
+		const FCompactRoomGrid& Grid = Layout.Grid;
+
+		int32 InteriorCells = 0;
+		for (int32 Index = 0; Index < Grid.Num(); ++Index)
+		{
+			if (Grid.Get(Index) == EGridCellType::ECT_FloorMesh)
+			{
+				++OutStats.FloorCells;
+				InteriorCells += Layout.InteriorOccupancy[Index] ? 1 : 0;
+			}
+		}
+
+		int32 WalkableCells = 0;
+		int32 LargestRegion = 0;
+		Layout.BuildWalkableMask(Walkable);
+		FGridBitMask::ForEachRegion(Walkable, [&](const FGridBitMask& Region, int32 NumCells, const FIntPoint& FirstCell)
+		{
+			++OutStats.NumRegions;
+			WalkableCells += NumCells;
+			LargestRegion = FMath::Max(LargestRegion, NumCells);
+		});
+
+		const float FloorCells = (float)FMath::Max(1, OutStats.FloorCells);
+		OutStats.FillerRatio = Layout.NumFillerTiles / FloorCells;
+		OutStats.FurnitureDensity = InteriorCells / FloorCells;
+		OutStats.LargestRegionFraction = WalkableCells > 0 ? (float)LargestRegion / WalkableCells : 0.0f;
+		OutStats.MeshVariety = Layout.Meshes.Num();
+		OutStats.NumPlacements = Layout.Placements.Num();
+	}
+
+	static bool PassesFilters(const FSeedStats& Stats, const FScoreSettings& Settings)
+	{
+		if (Settings.bRequireConnected && Stats.NumRegions > 1) return false;
+		return Stats.FillerRatio <= Settings.MaxFillerRatio;
+	}
+
+	static float Score(const FSeedStats& Stats, const FScoreSettings& Settings)
+	{
+		return Settings.ConnectivityWeight * Stats.LargestRegionFraction
+			+ Settings.FurnitureWeight * Stats.FurnitureDensity
+			- Settings.FillerWeight * Stats.FillerRatio
+			+ Settings.VarietyWeight * ((float)Stats.MeshVariety / Settings.PoolMeshCount);
+	}
+
+	// Min-heap on score, so the worst kept seed is always on top
+	static bool WorseScore(const FSeedStats& A, const FSeedStats& B)
+	{
+		return A.Score < B.Score;
+	}
+}
+
+URoomSeedMinerCommandlet::URoomSeedMinerCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 URoomSeedMinerCommandlet::Main(const FString& Params)
+{
+	using namespace RoomSeedMiner;
+
+	// 1. Parse arguments
+	FString RoomPath;
+	if (!FParse::Value(*Params, TEXT("Room="), RoomPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("URoomSeedMinerCommandlet: Missing -Room=<RoomData asset path>."));
+		return 1;
+	}
+
+	int64 NumSeeds = 1000000;
+	int64 StartSeed = 0;
+	int32 TopCount = 100;
+	FParse::Value(*Params, TEXT("Seeds="), NumSeeds);
+	FParse::Value(*Params, TEXT("StartSeed="), StartSeed);
+	FParse::Value(*Params, TEXT("Top="), TopCount);
+	NumSeeds = FMath::Max<int64>(1, NumSeeds);
+	TopCount = FMath::Max(1, TopCount);
+
+	// Seeds are int32; a range running past either end would wrap into duplicate or negative seeds
+	if (StartSeed < MIN_int32 || StartSeed > MAX_int32 || NumSeeds - 1 > (int64)MAX_int32 - StartSeed)
+	{
+		UE_LOG(LogTemp, Error, TEXT("URoomSeedMinerCommandlet: %lld seeds from %lld do not fit in int32 (%d..%d); lower -StartSeed or -Seeds."),
+			NumSeeds, StartSeed, MIN_int32, MAX_int32);
+		return 1;
+	}
+
+	FScoreSettings Settings;
+	FParse::Value(*Params, TEXT("ConnectivityWeight="), Settings.ConnectivityWeight);
+	FParse::Value(*Params, TEXT("FurnitureWeight="), Settings.FurnitureWeight);
+	FParse::Value(*Params, TEXT("FillerWeight="), Settings.FillerWeight);
+	FParse::Value(*Params, TEXT("VarietyWeight="), Settings.VarietyWeight);
+	FParse::Value(*Params, TEXT("MaxFillerRatio="), Settings.MaxFillerRatio);
+	Settings.bRequireConnected = !FParse::Param(*Params, TEXT("AllowDisconnected"));
+
+	// 2. Load the data assets once on the game thread; workers only read them
+	const URoomData* RoomData = LoadObject<URoomData>(nullptr, *RoomPath);
+	if (!RoomData)
+	{
+		UE_LOG(LogTemp, Error, TEXT("URoomSeedMinerCommandlet: Could not load RoomData '%s'."), *RoomPath);
+		return 1;
+	}
+
+	FRoomSolverInput Input;
+	Input.RoomData = RoomData;
+	Input.FloorData = RoomData->FloorStyleData.LoadSynchronous();
+	Input.WallData = RoomData->WallStyleData.LoadSynchronous();
+
+	if (Input.FloorData)
+	{
+		Settings.PoolMeshCount = FMath::Max(1, Input.FloorData->FloorTilePool.Num() + Input.FloorData->EdgeTilePool.Num() + RoomData->InteriorMeshPool.Num());
+	}
+
+	FString OutPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SeedMining"), RoomData->GetName() + TEXT("_Seeds.csv"));
+	FParse::Value(*Params, TEXT("Out="), OutPath);
+
+	// 3. Solve every seed in parallel, each batch keeping its own top list
+	const int32 NumBatches = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1) * 8;
+	TArray<TArray<FSeedStats>> BatchBest;
+	BatchBest.SetNum(NumBatches);
+
+	// Heap allocations in solves after each batch's first; the warm solver should not allocate at all
+	const bool bCountAllocations = FRoomLayoutSolver::EnableAllocationCounting();
+	std::atomic<int64> WarmHeapAllocations { 0 };
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ParallelFor(NumBatches, [&](int32 BatchIndex)
+	{
+		const int64 FirstOffset = NumSeeds * BatchIndex / NumBatches;
+		const int64 EndOffset = NumSeeds * (BatchIndex + 1) / NumBatches;
+
+		FRoomLayoutSolver Solver;
+		FRoomLayout Layout;
+		FGridBitMask Walkable;
+		FRoomSolverInput LocalInput = Input;
+		TArray<FSeedStats>& Best = BatchBest[BatchIndex];
+		Best.Reserve(TopCount + 1);
+
+		for (int64 Offset = FirstOffset; Offset < EndOffset; ++Offset)
+		{
+			LocalInput.Seed = (int32)(StartSeed + Offset);
+			if (!Solver.Solve(LocalInput, Layout)) continue;
+			if (Offset != FirstOffset && bCountAllocations)
+			{
+				WarmHeapAllocations += Solver.GetNumHeapAllocationsInLastSolve();
+			}
+
+			FSeedStats Stats;
+			Stats.Seed = LocalInput.Seed;
+			ComputeStats(Layout, Walkable, Stats);
+			if (!PassesFilters(Stats, Settings)) continue;
+
+			Stats.Score = Score(Stats, Settings);
+			if (Best.Num() < TopCount)
+			{
+				Best.HeapPush(Stats, WorseScore);
+			}
+			else if (Stats.Score > Best.HeapTop().Score)
+			{
+				Best.HeapPopDiscard(WorseScore, EAllowShrinking::No);
+				Best.HeapPush(Stats, WorseScore);
+			}
+		}
+	});
+
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// 4. Merge the batch results and write the CSV
+	TArray<FSeedStats> AllBest;
+	for (const TArray<FSeedStats>& Best : BatchBest)
+	{
+		AllBest.Append(Best);
+	}
+	AllBest.Sort([](const FSeedStats& A, const FSeedStats& B) { return A.Score > B.Score; });
+	if (AllBest.Num() > TopCount)
+	{
+		AllBest.SetNum(TopCount);
+	}
+
+	FString Csv = TEXT("Seed,Score,FloorCells,FillerRatio,FurnitureDensity,Regions,LargestRegionFraction,MeshVariety,Placements\n");
+	for (const FSeedStats& Stats : AllBest)
+	{
+		Csv += FString::Printf(TEXT("%d,%.4f,%d,%.4f,%.4f,%d,%.4f,%d,%d\n"),
+			Stats.Seed, Stats.Score, Stats.FloorCells, Stats.FillerRatio, Stats.FurnitureDensity,
+			Stats.NumRegions, Stats.LargestRegionFraction, Stats.MeshVariety, Stats.NumPlacements);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("URoomSeedMinerCommandlet: Could not write '%s'."), *OutPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("URoomSeedMinerCommandlet: Mined %lld seeds in %.2f s (%.0f seeds/s). %d kept, written to %s"),
+		NumSeeds, ElapsedSeconds, NumSeeds / FMath::Max(ElapsedSeconds, 0.001), AllBest.Num(), *OutPath);
+	if (bCountAllocations)
+	{
+		UE_LOG(LogTemp, Display, TEXT("URoomSeedMinerCommandlet: %lld heap allocations in warm solves."), WarmHeapAllocations.load());
+	}
+	return 0;
+}
@@ -2,25 +2,110 @@
 
 
 #include "GeminiDungeonGen/Public/DungeonGen/Doors/Doorway.h"
+#include "DungeonGen/Manager/DungeonManager.h"
 
 
 // Sets default values
 ADoorway::ADoorway()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Ticks only while animating; ApplyDoorState turns it on and Tick turns it back off
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// Replicated once so clients can resolve it, then dormant: state arrives through the manager
+	bReplicates = true;
+	NetDormancy = DORM_Initial;
+
+	DoorRoot = CreateDefaultSubobject<USceneComponent>(TEXT("DoorRoot"));
+	RootComponent = DoorRoot;
+
+	DoorPivot = CreateDefaultSubobject<USceneComponent>(TEXT("DoorPivot"));
+	DoorPivot->SetupAttachment(DoorRoot);
 }
 
 // Called when the game starts or when spawned
 void ADoorway::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// DORM_Initial only covers doors placed in the map; spawned doors go dormant after their first send
+	if (HasAuthority() && !IsNetStartupActor())
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
 }
 
-// Called every frame
 void ADoorway::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+	const float Step = OpenDuration > 0.0f ? DeltaTime / OpenDuration : 1.0f;
+	OpenAlpha = bIsOpen ? FMath::Min(OpenAlpha + Step, 1.0f) : FMath::Max(OpenAlpha - Step, 0.0f);
+	UpdatePivot();
+
+	if (OpenAlpha == (bIsOpen ? 1.0f : 0.0f))
+	{
+		SetActorTickEnabled(false);
+	}
 }
 
+void ADoorway::SetDoorOpen(bool bOpen)
+{
+	if (!HasAuthority()) return;
+
+	if (OwningManager && DoorStateIndex != INDEX_NONE)
+	{
+		OwningManager->SetDoorOpen(DoorStateIndex, bOpen);
+	}
+	else if (!bIsLocked || !bOpen)
+	{
+		// Unregistered door: local state only
+		ApplyDoorState(bOpen, bIsLocked, false);
+	}
+}
+
+void ADoorway::SetDoorLocked(bool bLocked)
+{
+	if (!HasAuthority()) return;
+
+	if (OwningManager && DoorStateIndex != INDEX_NONE)
+	{
+		OwningManager->SetDoorLocked(DoorStateIndex, bLocked);
+	}
+	else
+	{
+		ApplyDoorState(bIsOpen, bLocked, false);
+	}
+}
+
+void ADoorway::ApplyDoorState(bool bOpen, bool bLocked, bool bSnap)
+{
+	const bool bChanged = (bOpen != bIsOpen) || (bLocked != bIsLocked);
+	bIsOpen = bOpen;
+	bIsLocked = bLocked;
+
+	const float TargetAlpha = bIsOpen ? 1.0f : 0.0f;
+	if (bSnap || OpenDuration <= 0.0f)
+	{
+		OpenAlpha = TargetAlpha;
+		UpdatePivot();
+		SetActorTickEnabled(false);
+	}
+	else if (OpenAlpha != TargetAlpha)
+	{
+		SetActorTickEnabled(true);
+	}
+
+	if (bChanged)
+	{
+		OnDoorStateChanged(bIsOpen, bIsLocked);
+	}
+}
+
+void ADoorway::UpdatePivot()
+{
+	if (DoorPivot)
+	{
+		DoorPivot->SetRelativeRotation(FRotator(0.0f, OpenYaw * OpenAlpha, 0.0f));
+	}
+}
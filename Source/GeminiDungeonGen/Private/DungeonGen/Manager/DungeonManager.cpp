@@ -2,26 +2,1047 @@
 
 
 #include "DungeonGen/Manager/DungeonManager.h"
+#include "DungeonGen/Rooms/MasterRoom.h"
+#include "DungeonGen/Doors/Doorway.h"
+#include "Data/Grid/GridBitMask.h"
+#include "Data/Grid/GridData.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/BoxComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "TimerManager.h"
+#include "Data/Room/RoomData.h"
+#include "Data/Room/FloorData.h"
+#include "Data/Room/WallData.h"
+#include "Data/Room/DoorData.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StaticMesh.h"
+#include "Net/UnrealNetwork.h"
+
+namespace DungeonPrefetch
+{
+	// Below the default priority so prefetching never delays loads the current floor is waiting on
+	static const TAsyncLoadPriority Priority = FStreamableManager::DefaultAsyncLoadPriority - 50;
+
+	// Detail meshes are requested in small batches so the budget can be checked between them
+	static constexpr int32 DetailBatchSize = 8;
+
+	static void AddPath(const TSoftObjectPtr<UStaticMesh>& Mesh, TArray<FSoftObjectPath>& OutPaths)
+	{
+		if (!Mesh.IsNull())
+		{
+			OutPaths.AddUnique(Mesh.ToSoftObjectPath());
+		}
+	}
+
+	static void AddPool(const TArray<FMeshPlacementInfo>& Pool, TArray<FSoftObjectPath>& OutPaths)
+	{
+		for (const FMeshPlacementInfo& Info : Pool)
+		{
+			AddPath(Info.MeshAsset, OutPaths);
+		}
+	}
+}
 
 // Sets default values
 ADungeonManager::ADungeonManager()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Event driven (generation, floor changes, door requests); nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
 
+	// Floor index and dungeon seed replicate so clients can prefetch the same floors as the server
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	// Parent for the shared HISMs (instances are added in world space)
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 }
 
 // Called when the game starts or when spawned
 void ADungeonManager::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (HasAuthority())
+	{
+		for (const FDungeonDoorLink& Link : DoorLinks)
+		{
+			if (Link.Door && Link.Door->DoorStateIndex == INDEX_NONE)
+			{
+				RegisterDoor(Link.Door);
+			}
+		}
+	}
+
+	// Clients solve their rooms from the replicated seeds; give them the setup GenerateDungeon gives the
+	// server's rooms. Rooms whose seed arrived first are rebuilt under that setup from their layout.
+	if (!HasAuthority())
+	{
+		const bool bLazy = UsesLazyMaterialization();
+		for (AMasterRoom* Room : Rooms)
+		{
+			if (!Room) continue;
+
+			Room->Dematerialize();
+			ConfigureRoom(Room);
+			if (!bLazy && Room->HasSolvedLayout())
+			{
+				Room->Materialize();
+			}
+		}
+	}
+
+	// Clients wait for OnRep_DungeonSeed: until then the room list would be resolved from the level default
+	if (bPrefetchNextFloor && HasAuthority())
+	{
+		PrefetchFloor(CurrentFloorIndex + 1);
+	}
+
+	// A timer rather than Tick: relevance only needs to follow players a few times a second
+	if (UsesLazyMaterialization())
+	{
+		GetWorldTimerManager().SetTimer(RelevanceTimerHandle, this, &ADungeonManager::UpdateRoomRelevance, FMath::Max(0.05f, RelevanceCheckInterval), true);
+	}
+}
+
+void ADungeonManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Always notify, so clients also start prefetching when the seed matches the level default
+	DOREPLIFETIME_CONDITION_NOTIFY(ADungeonManager, DungeonSeed, COND_None, REPNOTIFY_Always);
+	DOREPLIFETIME(ADungeonManager, CurrentFloorIndex);
+	DOREPLIFETIME(ADungeonManager, DoorStates);
+}
+
+void ADungeonManager::GenerateDungeon()
+{
+	// Server Check: clients receive seeds, they never generate the dungeon themselves
+	if (!HasAuthority()) return;
+
+	const bool bLazy = UsesLazyMaterialization();
+	for (AMasterRoom* Room : Rooms)
+	{
+		if (Room)
+		{
+			ConfigureRoom(Room);
+			Room->RegenerateRoom();
+		}
+	}
+
+	if (bValidateConnectivity)
+	{
+		ValidateAndRepair();
+	}
+
+	// Bring the rooms around the players in now rather than on the next timer tick
+	if (bLazy)
+	{
+		UpdateRoomRelevance();
+	}
+}
+
+FDungeonConnectivityReport ADungeonManager::ValidateConnectivity() const
+{
+	FDungeonConnectivityReport Report;
+
+	// Graph nodes are (room, walkable region) pairs
+	TArray<int32> NodeCells;
+	TArray<int32> NodeRoom;
+	TArray<FIntPoint> NodeSample;
+	TArray<int32> RoomFirstNode;
+	TArray<int32> LinkNodeA;
+	TArray<int32> LinkNodeB;
+	LinkNodeA.Init(INDEX_NONE, DoorLinks.Num());
+	LinkNodeB.Init(INDEX_NONE, DoorLinks.Num());
+	RoomFirstNode.Init(INDEX_NONE, Rooms.Num() + 1);
+
+	// 0. Bucket the door link endpoints by room once, so each region only tests its own room's doors
+	struct FLinkEndpoint
+	{
+		int32 LinkIndex;
+		bool bSideB;
+		FIntPoint Cell;
+	};
+	TMap<const AMasterRoom*, int32> RoomIndices;
+	RoomIndices.Reserve(Rooms.Num());
+	for (int32 RoomIndex = 0; RoomIndex < Rooms.Num(); ++RoomIndex)
+	{
+		if (Rooms[RoomIndex] && !RoomIndices.Contains(Rooms[RoomIndex]))
+		{
+			RoomIndices.Add(Rooms[RoomIndex], RoomIndex);
+		}
+	}
+
+	TArray<TArray<FLinkEndpoint, TInlineAllocator<4>>> RoomEndpoints;
+	RoomEndpoints.SetNum(Rooms.Num());
+	for (int32 LinkIndex = 0; LinkIndex < DoorLinks.Num(); ++LinkIndex)
+	{
+		const FDungeonDoorLink& Link = DoorLinks[LinkIndex];
+		if (const int32* RoomIndex = RoomIndices.Find(Link.RoomA))
+		{
+			RoomEndpoints[*RoomIndex].Add({ LinkIndex, false, Link.CellA });
+		}
+		if (const int32* RoomIndex = RoomIndices.Find(Link.RoomB))
+		{
+			RoomEndpoints[*RoomIndex].Add({ LinkIndex, true, Link.CellB });
+		}
+	}
+
+	// 1. Split every room into walkable regions and find the region behind each door cell
+	FGridBitMask Walkable;
+	for (int32 RoomIndex = 0; RoomIndex < Rooms.Num(); ++RoomIndex)
+	{
+		RoomFirstNode[RoomIndex] = NodeCells.Num();
+
+		const AMasterRoom* Room = Rooms[RoomIndex];
+		if (!Room) continue;
+
+		Room->BuildWalkableMask(Walkable);
+		FGridBitMask::ForEachRegion(Walkable, [&](const FGridBitMask& Region, int32 NumCells, const FIntPoint& FirstCell)
+		{
+			const int32 Node = NodeCells.Add(NumCells);
+			NodeRoom.Add(RoomIndex);
+			NodeSample.Add(FirstCell);
+
+			for (const FLinkEndpoint& Endpoint : RoomEndpoints[RoomIndex])
+			{
+				if (Region.IsValidCell(Endpoint.Cell.X, Endpoint.Cell.Y) && Region.Get(Endpoint.Cell.X, Endpoint.Cell.Y))
+				{
+					(Endpoint.bSideB ? LinkNodeB : LinkNodeA)[Endpoint.LinkIndex] = Node;
+				}
+			}
+		});
+	}
+	RoomFirstNode[Rooms.Num()] = NodeCells.Num();
+
+	// 2. BFS over door links, starting from the largest region of the start room
+	TArray<TArray<int32>> Adjacency;
+	Adjacency.SetNum(NodeCells.Num());
+	for (int32 LinkIndex = 0; LinkIndex < DoorLinks.Num(); ++LinkIndex)
+	{
+		if (LinkNodeA[LinkIndex] != INDEX_NONE && LinkNodeB[LinkIndex] != INDEX_NONE)
+		{
+			Adjacency[LinkNodeA[LinkIndex]].Add(LinkNodeB[LinkIndex]);
+			Adjacency[LinkNodeB[LinkIndex]].Add(LinkNodeA[LinkIndex]);
+		}
+	}
+
+	TBitArray<> Visited(false, NodeCells.Num());
+	if (Rooms.Num() > 0 && RoomFirstNode[1] > RoomFirstNode[0])
+	{
+		int32 StartNode = RoomFirstNode[0];
+		for (int32 Node = RoomFirstNode[0]; Node < RoomFirstNode[1]; ++Node)
+		{
+			if (NodeCells[Node] > NodeCells[StartNode])
+			{
+				StartNode = Node;
+			}
+		}
+
+		TArray<int32> Queue;
+		Queue.Add(StartNode);
+		Visited[StartNode] = true;
+		for (int32 QueueIndex = 0; QueueIndex < Queue.Num(); ++QueueIndex)
+		{
+			for (const int32 Neighbour : Adjacency[Queue[QueueIndex]])
+			{
+				if (!Visited[Neighbour])
+				{
+					Visited[Neighbour] = true;
+					Queue.Add(Neighbour);
+				}
+			}
+		}
+	}
+
+	// 3. Gather per-room issues
+	for (int32 RoomIndex = 0; RoomIndex < Rooms.Num(); ++RoomIndex)
+	{
+		AMasterRoom* Room = Rooms[RoomIndex];
+		if (!Room) continue;
+
+		FRoomConnectivityIssue Issue;
+		Issue.Room = Room;
+
+		for (int32 Node = RoomFirstNode[RoomIndex]; Node < RoomFirstNode[RoomIndex + 1]; ++Node)
+		{
+			if (NodeCells[Node] < MinReportedRegionCells) continue;
+
+			++Issue.NumRegions;
+			if (!Visited[Node])
+			{
+				if (Issue.UnreachableCells == 0)
+				{
+					Issue.SampleCell = NodeSample[Node];
+				}
+				Issue.UnreachableCells += NodeCells[Node];
+			}
+		}
+
+		for (const FLinkEndpoint& Endpoint : RoomEndpoints[RoomIndex])
+		{
+			Issue.BlockedDoorCells += (Endpoint.bSideB ? LinkNodeB : LinkNodeA)[Endpoint.LinkIndex] == INDEX_NONE ? 1 : 0;
+		}
+
+		Issue.bNeedsRepair = Issue.NumRegions > 1 || Issue.BlockedDoorCells > 0;
+
+		if (Issue.UnreachableCells > 0 || Issue.bNeedsRepair)
+		{
+			Report.bIsTraversable = false;
+			Report.Issues.Add(Issue);
+		}
+	}
+
+	return Report;
+}
+
+bool ADungeonManager::ValidateAndRepair()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	FDungeonConnectivityReport Report = ValidateConnectivity();
+	for (int32 Attempt = 1; !Report.bIsTraversable && Attempt <= MaxRepairRerolls; ++Attempt)
+	{
+		// Reroll only the rooms whose own layout is broken; the rest of the dungeon is untouched
+		bool bRerolled = false;
+		for (const FRoomConnectivityIssue& Issue : Report.Issues)
+		{
+			if (Issue.bNeedsRepair && Issue.Room)
+			{
+				Issue.Room->GenerationSeed = (int32)HashCombine(GetTypeHash(Issue.Room->GenerationSeed), GetTypeHash(Attempt));
+				Issue.Room->RegenerateRoom();
+				bRerolled = true;
+			}
+		}
+
+		// Whatever is left comes from missing door links, which a reroll cannot fix
+		if (!bRerolled) break;
+
+		Report = ValidateConnectivity();
+	}
+
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	if (!Report.bIsTraversable)
+	{
+		for (const FRoomConnectivityIssue& Issue : Report.Issues)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ADungeonManager: %s has %d unreachable cells (e.g. %s), %d regions, %d blocked door cells."),
+				*GetNameSafe(Issue.Room), Issue.UnreachableCells, *Issue.SampleCell.ToString(), Issue.NumRegions, Issue.BlockedDoorCells);
+		}
+	}
+	UE_LOG(LogTemp, Verbose, TEXT("ADungeonManager: Connectivity validation took %.2f ms (%s)."), ElapsedMs, Report.bIsTraversable ? TEXT("traversable") : TEXT("NOT traversable"));
+
+	return Report.bIsTraversable;
+}
+
+// --- SHARED INSTANCING ---
+
+int32 ADungeonManager::GetOrCreateSharedHISM(UStaticMesh* Mesh, const FIntPoint& SpatialCell, bool bCollision)
+{
+	const TTuple<TObjectKey<UStaticMesh>, FIntPoint, bool> Key(Mesh, SpatialCell, bCollision);
+	const int32* ExistingIndex = SharedHISMLookup.Find(Key);
+	if (ExistingIndex && IsValid(SharedHISMComponents[*ExistingIndex]))
+	{
+		return *ExistingIndex;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* NewHISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	NewHISM->SetStaticMesh(Mesh);
+	NewHISM->SetCollisionEnabled(bCollision ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision);
+	NewHISM->SetupAttachment(RootComponent);
+	NewHISM->RegisterComponent();
+
+	// A destroyed component took its instances with it; its entry is reused with no ranges
+	if (ExistingIndex)
+	{
+		SharedHISMComponents[*ExistingIndex] = NewHISM;
+		SharedHISMs[*ExistingIndex].Ranges.Reset();
+		return *ExistingIndex;
+	}
+
+	const int32 EntryIndex = SharedHISMs.AddDefaulted();
+	SharedHISMComponents.Add(NewHISM);
+	SharedHISMLookup.Add(Key, EntryIndex);
+	return EntryIndex;
+}
+
+void ADungeonManager::AddSharedInstances(AMasterRoom* Room, UStaticMesh* Mesh, TConstArrayView<FTransform> WorldTransforms, bool bCollision)
+{
+	if (!Room || !Mesh || WorldTransforms.Num() == 0) return;
+
+	// 1. Bucket the instances by spatial cell so each shared HISM stays compact for culling
+	const double CellWorldSize = FMath::Max(1, SharedMeshCellSize) * CELL_SIZE;
+	TMap<FIntPoint, TArray<FTransform>> Buckets;
+	for (const FTransform& Transform : WorldTransforms)
+	{
+		const FIntPoint SpatialCell(
+			FMath::FloorToInt32(Transform.GetLocation().X / CellWorldSize),
+			FMath::FloorToInt32(Transform.GetLocation().Y / CellWorldSize)
+		);
+		Buckets.FindOrAdd(SpatialCell).Add(Transform);
+	}
+
+	// 2. Append each bucket as one contiguous range at the end of its HISM
+	TArray<int32>& RoomEntries = RoomSharedHISMs.FindOrAdd(Room);
+	for (const auto& Pair : Buckets)
+	{
+		const int32 EntryIndex = GetOrCreateSharedHISM(Mesh, Pair.Key, bCollision);
+		UHierarchicalInstancedStaticMeshComponent* HISM = SharedHISMComponents[EntryIndex];
+
+		FSharedInstanceRange& Range = SharedHISMs[EntryIndex].Ranges.AddDefaulted_GetRef();
+		Range.Room = Room;
+		Range.Start = HISM->GetInstanceCount();
+		Range.Count = Pair.Value.Num();
+
+		HISM->AddInstances(Pair.Value, false, true);
+		RoomEntries.AddUnique(EntryIndex);
+	}
+}
+
+void ADungeonManager::RemoveSharedInstances(AMasterRoom* Room)
+{
+	TArray<int32> RoomEntries;
+	if (!RoomSharedHISMs.RemoveAndCopyValue(Room, RoomEntries)) return;
+
+	const TObjectKey<AMasterRoom> RoomKey(Room);
+	for (const int32 EntryIndex : RoomEntries)
+	{
+		FSharedHISMEntry& Entry = SharedHISMs[EntryIndex];
+
+		// The component is gone (and its instances with it); only the bookkeeping is left
+		if (!IsValid(SharedHISMComponents[EntryIndex]))
+		{
+			Entry.Ranges.RemoveAll([&RoomKey](const FSharedInstanceRange& Range) { return Range.Room == RoomKey; });
+			continue;
+		}
+
+		// Highest range first: a room's last range is often the tail, which needs no moves at all.
+		// Removal can split and reorder ranges, so search again after every removal.
+		for (;;)
+		{
+			int32 RangeIndex = INDEX_NONE;
+			for (int32 Index = Entry.Ranges.Num() - 1; Index >= 0; --Index)
+			{
+				if (Entry.Ranges[Index].Room == RoomKey)
+				{
+					RangeIndex = Index;
+					break;
+				}
+			}
+			if (RangeIndex == INDEX_NONE) break;
+
+			RemoveInstanceRange(EntryIndex, RangeIndex);
+		}
+	}
+}
+
+void ADungeonManager::RemoveInstanceRange(int32 EntryIndex, int32 RangeIndex)
+{
+	FSharedHISMEntry& Entry = SharedHISMs[EntryIndex];
+	const FSharedInstanceRange Removed = Entry.Ranges[RangeIndex];
+	Entry.Ranges.RemoveAt(RangeIndex);
+
+	UHierarchicalInstancedStaticMeshComponent* HISM = SharedHISMComponents[EntryIndex];
+	const int32 NumInstances = HISM->GetInstanceCount();
+	const int32 RemovedEnd = Removed.Start + Removed.Count;
+
+	// 1. Swap removal: the last instances that are not part of the range fill its hole.
+	//    Only min(Count, instances behind the range) transforms move, never the whole tail.
+	const int32 MoveStart = FMath::Max(NumInstances - Removed.Count, RemovedEnd);
+	const int32 NumMoved = NumInstances - MoveStart;
+	if (NumMoved > 0)
+	{
+		TArray<FTransform> MovedTransforms;
+		MovedTransforms.SetNum(NumMoved);
+		for (int32 Offset = 0; Offset < NumMoved; ++Offset)
+		{
+			HISM->GetInstanceTransform(MoveStart + Offset, MovedTransforms[Offset], true);
+		}
+		HISM->BatchUpdateInstancesTransforms(Removed.Start, MovedTransforms, true, false, true);
+	}
+
+	// 2. Drop the now unused tail. Removing the last indices gives the same result whether
+	//    the component removes by shifting or by swapping, so the ranges stay exact.
+	TArray<int32> TailIndices;
+	TailIndices.Reserve(Removed.Count);
+	for (int32 InstanceIndex = NumInstances - 1; InstanceIndex >= NumInstances - Removed.Count; --InstanceIndex)
+	{
+		TailIndices.Add(InstanceIndex);
+	}
+	HISM->RemoveInstances(TailIndices, true);
+
+	if (NumMoved == 0) return;
+
+	// 3. Remap the ranges that were moved into the hole. A range straddling MoveStart is split:
+	//    its front stays, its back becomes a new range of the same room inside the hole.
+	const int32 MoveOffset = Removed.Start - MoveStart;
+	for (int32 Index = Entry.Ranges.Num() - 1; Index >= 0; --Index)
+	{
+		FSharedInstanceRange& Range = Entry.Ranges[Index];
+		const int32 RangeEnd = Range.Start + Range.Count;
+		if (RangeEnd <= MoveStart) break;
+
+		if (Range.Start >= MoveStart)
+		{
+			Range.Start += MoveOffset;
+		}
+		else
+		{
+			FSharedInstanceRange MovedPart;
+			MovedPart.Room = Range.Room;
+			MovedPart.Start = Removed.Start;
+			MovedPart.Count = RangeEnd - MoveStart;
+			Range.Count -= MovedPart.Count;
+			Entry.Ranges.Add(MovedPart);
+			break;
+		}
+	}
+
+	// Keep the ranges sorted by Start (the moved ones now sit where the removed range was)
+	Entry.Ranges.Sort([](const FSharedInstanceRange& A, const FSharedInstanceRange& B) { return A.Start < B.Start; });
+}
+
+// --- RELEVANCE ---
+
+void ADungeonManager::ConfigureRoom(AMasterRoom* Room)
+{
+	Room->SetLazyMaterialization(UsesLazyMaterialization() ? this : nullptr);
+	Room->SetSharedInstanceManager(bShareInstancedMeshes ? this : nullptr);
+}
+
+bool ADungeonManager::UsesLazyMaterialization() const
+{
+	const UWorld* World = GetWorld();
+	return bLazyMaterialization && World && World->IsGameWorld() && !IsRunningDedicatedServer();
+}
+
+void ADungeonManager::UpdateRoomRelevance()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	// 1. Every player this instance simulates: on a client its own, on a listen server all of them
+	//    (remote players need collision around them on the server too)
+	TArray<FVector, TInlineAllocator<8>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController) continue;
+
+		if (const APawn* Pawn = PlayerController->GetPawn())
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+		else if (PlayerController->PlayerCameraManager)
+		{
+			PlayerLocations.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+
+	// 2. Release rooms beyond radius + hysteresis right away; collect rooms in range that are missing
+	const double MaterializeDistSq = FMath::Square((double)MaterializeRadius);
+	const double DematerializeDistSq = FMath::Square((double)MaterializeRadius + DematerializeHysteresis);
+
+	TArray<TPair<double, AMasterRoom*>> ToMaterialize;
+	for (AMasterRoom* Room : Rooms)
+	{
+		// Nothing to materialize before the room has solved (clients: before its seed has replicated)
+		if (!Room || !Room->HasSolvedLayout()) continue;
+
+		const FBox Bounds = Room->GetLayoutBounds();
+		double NearestDistSq = TNumericLimits<double>::Max();
+		for (const FVector& Location : PlayerLocations)
+		{
+			NearestDistSq = FMath::Min(NearestDistSq, Bounds.ComputeSquaredDistanceToPoint(Location));
+		}
+
+		if (Room->IsMaterialized())
+		{
+			if (NearestDistSq > DematerializeDistSq)
+			{
+				Room->Dematerialize();
+			}
+		}
+		else if (NearestDistSq <= MaterializeDistSq)
+		{
+			ToMaterialize.Emplace(NearestDistSq, Room);
+		}
+	}
+
+	// 3. Nearest rooms first, capped per check so a teleport doesn't spawn the whole area in one frame
+	ToMaterialize.Sort([](const TPair<double, AMasterRoom*>& A, const TPair<double, AMasterRoom*>& B) { return A.Key < B.Key; });
+
+	const int32 NumToMaterialize = MaxMaterializationsPerCheck > 0 ? FMath::Min(MaxMaterializationsPerCheck, ToMaterialize.Num()) : ToMaterialize.Num();
+	for (int32 Index = 0; Index < NumToMaterialize; ++Index)
+	{
+		ToMaterialize[Index].Value->Materialize();
+	}
+}
+
+int32 ADungeonManager::GetNumMaterializedRooms() const
+{
+	int32 NumMaterialized = 0;
+	for (const AMasterRoom* Room : Rooms)
+	{
+		NumMaterialized += (Room && Room->IsMaterialized()) ? 1 : 0;
+	}
+	return NumMaterialized;
+}
+
+UHierarchicalInstancedStaticMeshComponent* ADungeonManager::AcquirePooledHISM()
+{
+	if (HISMPool.Num() > 0)
+	{
+		return HISMPool.Pop();
+	}
+	return NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+}
+
+void ADungeonManager::ReleasePooledHISM(UHierarchicalInstancedStaticMeshComponent* HISM)
+{
+	if (!HISM) return;
+
+	// Instance data, render state and physics bodies are freed; only the UObject stays for reuse
+	HISM->ClearInstances();
+	HISM->DetachFromComponent(FDetachmentTransformRules::KeepRelativeTransform);
+	HISM->UnregisterComponent();
+	HISM->SetStaticMesh(nullptr);
+	HISMPool.Add(HISM);
+}
+
+UBoxComponent* ADungeonManager::AcquirePooledBox()
+{
+	if (BoxPool.Num() > 0)
+	{
+		return BoxPool.Pop();
+	}
+	return NewObject<UBoxComponent>(this);
+}
+
+void ADungeonManager::ReleasePooledBox(UBoxComponent* BoxComponent)
+{
+	if (!BoxComponent) return;
+
+	BoxComponent->DetachFromComponent(FDetachmentTransformRules::KeepRelativeTransform);
+	BoxComponent->UnregisterComponent();
+	BoxPool.Add(BoxComponent);
+}
+
+// --- DOOR STATE ---
+
+void FDoorStateItem::PostReplicatedAdd(const FDoorStateArray& InArraySerializer)
+{
+	// Late joiners get the current state without replaying the animation
+	if (Door)
+	{
+		Door->ApplyDoorState(bOpen, bLocked, true);
+	}
+}
+
+void FDoorStateItem::PostReplicatedChange(const FDoorStateArray& InArraySerializer)
+{
+	if (Door)
+	{
+		Door->ApplyDoorState(bOpen, bLocked, false);
+	}
+}
+
+int32 ADungeonManager::RegisterDoor(ADoorway* Door, bool bStartOpen, bool bStartLocked)
+{
+	if (!HasAuthority() || !Door) return INDEX_NONE;
+
+	if (Door->OwningManager == this && DoorStates.Items.IsValidIndex(Door->DoorStateIndex))
+	{
+		return Door->DoorStateIndex;
+	}
+
+	FDoorStateItem& Item = DoorStates.Items.AddDefaulted_GetRef();
+	Item.Door = Door;
+	Item.bOpen = bStartOpen && !bStartLocked;
+	Item.bLocked = bStartLocked;
+	DoorStates.MarkItemDirty(Item);
+
+	Door->OwningManager = this;
+	Door->DoorStateIndex = DoorStates.Items.Num() - 1;
+	Door->ApplyDoorState(Item.bOpen, Item.bLocked, true);
+
+	return Door->DoorStateIndex;
+}
+
+void ADungeonManager::SetDoorOpen(int32 DoorIndex, bool bOpen)
+{
+	if (!HasAuthority() || !DoorStates.Items.IsValidIndex(DoorIndex)) return;
+
+	FDoorStateItem& Item = DoorStates.Items[DoorIndex];
+	if (Item.bOpen == bOpen) return;
+
+	// Locked doors stay shut, but can always be closed
+	if (bOpen && Item.bLocked) return;
+
+	Item.bOpen = bOpen;
+	DoorStates.MarkItemDirty(Item);
+
+	// The server (and a listen server's local player) applies directly; clients via PostReplicatedChange
+	if (Item.Door)
+	{
+		Item.Door->ApplyDoorState(Item.bOpen, Item.bLocked, false);
+	}
+}
+
+void ADungeonManager::SetDoorLocked(int32 DoorIndex, bool bLocked)
+{
+	if (!HasAuthority() || !DoorStates.Items.IsValidIndex(DoorIndex)) return;
+
+	FDoorStateItem& Item = DoorStates.Items[DoorIndex];
+	if (Item.bLocked == bLocked) return;
+
+	Item.bLocked = bLocked;
+	DoorStates.MarkItemDirty(Item);
+
+	if (Item.Door)
+	{
+		Item.Door->ApplyDoorState(Item.bOpen, Item.bLocked, false);
+	}
 }
 
-// Called every frame
-void ADungeonManager::Tick(float DeltaTime)
+bool ADungeonManager::IsDoorOpen(int32 DoorIndex) const
 {
-	Super::Tick(DeltaTime);
+	return DoorStates.Items.IsValidIndex(DoorIndex) && DoorStates.Items[DoorIndex].bOpen;
+}
+
+bool ADungeonManager::IsDoorLocked(int32 DoorIndex) const
+{
+	return DoorStates.Items.IsValidIndex(DoorIndex) && DoorStates.Items[DoorIndex].bLocked;
+}
+
+// --- FLOOR STREAMING ---
+
+void ADungeonManager::ResolveFloorRooms(int32 FloorIndex, TArray<TSoftObjectPtr<URoomData>>& OutRoomData) const
+{
+	OutRoomData.Reset(Rooms.Num());
+
+	// Same stream on server and clients, so both resolve (and prefetch) identical room data
+	FRandomStream FloorStream((int32)HashCombine(GetTypeHash(DungeonSeed), GetTypeHash(FloorIndex)));
+
+	for (const AMasterRoom* Room : Rooms)
+	{
+		if (RoomDataPool.Num() > 0)
+		{
+			OutRoomData.Add(RoomDataPool[FloorStream.RandRange(0, RoomDataPool.Num() - 1)]);
+		}
+		else
+		{
+			// No pool: every floor reuses the room data already assigned to the room
+			OutRoomData.Add(Room ? TSoftObjectPtr<URoomData>(Room->RoomDataAsset) : TSoftObjectPtr<URoomData>());
+		}
+	}
+}
+
+int32 ADungeonManager::GetFloorRoomSeed(int32 FloorIndex, int32 RoomIndex) const
+{
+	const uint32 FloorHash = HashCombine(GetTypeHash(DungeonSeed), GetTypeHash(FloorIndex));
+	return (int32)HashCombine(FloorHash, GetTypeHash(RoomIndex));
+}
+
+void ADungeonManager::AdvanceToNextFloor()
+{
+	// Server Check: clients follow through OnRep_CurrentFloorIndex
+	if (!HasAuthority()) return;
+
+	// Already waiting for the next floor's structural meshes
+	if (PendingFloorIndex != INDEX_NONE) return;
+
+	BeginFloorAdvance(CurrentFloorIndex + 1);
+}
+
+void ADungeonManager::BeginFloorAdvance(int32 FloorIndex)
+{
+	PendingFloorIndex = FloorIndex;
+
+	// The switch waits for the floor's structural stage, so nothing after it has to load synchronously
+	if (PrefetchedFloorIndex != FloorIndex)
+	{
+		PrefetchFloor(FloorIndex);
+	}
+	else if (bPrefetchStructuralLoaded)
+	{
+		FinishFloorAdvance();
+	}
+}
+
+void ADungeonManager::FinishFloorAdvance()
+{
+	const int32 FloorIndex = PendingFloorIndex;
+	PendingFloorIndex = INDEX_NONE;
+
+	if (HasAuthority())
+	{
+		// Room and style data are resident by now, so these loads resolve without touching the disk
+		TArray<TSoftObjectPtr<URoomData>> FloorRoomData;
+		ResolveFloorRooms(FloorIndex, FloorRoomData);
+
+		CurrentFloorIndex = FloorIndex;
+		HandOverPrefetchedFloor();
+
+		for (int32 RoomIndex = 0; RoomIndex < Rooms.Num(); ++RoomIndex)
+		{
+			AMasterRoom* Room = Rooms[RoomIndex];
+			if (!Room) continue;
+
+			if (RoomDataPool.Num() > 0)
+			{
+				Room->RoomDataAsset = FloorRoomData[RoomIndex].LoadSynchronous();
+			}
+			Room->GenerationSeed = GetFloorRoomSeed(CurrentFloorIndex, RoomIndex);
+		}
+
+		GenerateDungeon();
+	}
+	else
+	{
+		HandOverPrefetchedFloor();
+	}
 
+	if (bPrefetchNextFloor)
+	{
+		PrefetchFloor(CurrentFloorIndex + 1);
+	}
 }
 
+void ADungeonManager::OnRep_DungeonSeed()
+{
+	// Anything queued before the seed arrived resolved the wrong rooms
+	ReleaseHandles(NextFloorHandles);
+	PrefetchedFloorIndex = INDEX_NONE;
+	bPrefetchStructuralLoaded = false;
+
+	if (PendingFloorIndex != INDEX_NONE)
+	{
+		PrefetchFloor(PendingFloorIndex);
+	}
+	else if (bPrefetchNextFloor)
+	{
+		PrefetchFloor(CurrentFloorIndex + 1);
+	}
+}
+
+void ADungeonManager::OnRep_CurrentFloorIndex()
+{
+	// Same wait as the server: hand over once the floor's structural meshes are resident
+	BeginFloorAdvance(CurrentFloorIndex);
+}
+
+void ADungeonManager::HandOverPrefetchedFloor()
+{
+	// The floor we are leaving is no longer referenced by any handle and can be evicted
+	ReleaseHandles(CurrentFloorHandles);
+
+	CurrentFloorHandles = MoveTemp(NextFloorHandles);
+	NextFloorHandles.Reset();
+
+	// Only the detail stage can still be in flight (callers wait for the structural stage);
+	// it sees the index change and stops, and the remaining detail meshes load on demand
+	PrefetchedFloorIndex = INDEX_NONE;
+	bPrefetchStructuralLoaded = false;
+	PrefetchRoomData.Reset();
+	PrefetchStructuralMeshes.Reset();
+	PrefetchDetailMeshes.Reset();
+	PrefetchDetailCursor = 0;
+}
+
+void ADungeonManager::PrefetchFloor(int32 FloorIndex)
+{
+	if (FloorIndex == PrefetchedFloorIndex) return;
+
+	// A different floor was queued; drop it (releasing an in-flight handle cancels its callback)
+	ReleaseHandles(NextFloorHandles);
+
+	PrefetchedFloorIndex = FloorIndex;
+	bPrefetchStructuralLoaded = false;
+	PrefetchStructuralMeshes.Reset();
+	PrefetchDetailMeshes.Reset();
+	PrefetchDetailCursor = 0;
+
+	ResolveFloorRooms(FloorIndex, PrefetchRoomData);
+
+	TArray<FSoftObjectPath> RoomDataPaths;
+	for (const TSoftObjectPtr<URoomData>& RoomData : PrefetchRoomData)
+	{
+		if (!RoomData.IsNull())
+		{
+			RoomDataPaths.AddUnique(RoomData.ToSoftObjectPath());
+		}
+	}
+
+	if (RoomDataPaths.Num() == 0)
+	{
+		OnPrefetchStructuralLoaded(FloorIndex);
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		RoomDataPaths, FStreamableDelegate::CreateUObject(this, &ADungeonManager::OnPrefetchRoomDataLoaded, FloorIndex), DungeonPrefetch::Priority);
+	if (Handle.IsValid())
+	{
+		NextFloorHandles.Add(Handle);
+	}
+}
+
+void ADungeonManager::OnPrefetchRoomDataLoaded(int32 FloorIndex)
+{
+	if (FloorIndex != PrefetchedFloorIndex) return;
+
+	TArray<FSoftObjectPath> StylePaths;
+	for (const TSoftObjectPtr<URoomData>& RoomDataPtr : PrefetchRoomData)
+	{
+		const URoomData* RoomData = RoomDataPtr.Get();
+		if (!RoomData) continue;
+
+		if (!RoomData->FloorStyleData.IsNull()) StylePaths.AddUnique(RoomData->FloorStyleData.ToSoftObjectPath());
+		if (!RoomData->WallStyleData.IsNull()) StylePaths.AddUnique(RoomData->WallStyleData.ToSoftObjectPath());
+		if (!RoomData->DoorStyleData.IsNull()) StylePaths.AddUnique(RoomData->DoorStyleData.ToSoftObjectPath());
+	}
+
+	if (StylePaths.Num() == 0)
+	{
+		OnPrefetchStyleDataLoaded(FloorIndex);
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		StylePaths, FStreamableDelegate::CreateUObject(this, &ADungeonManager::OnPrefetchStyleDataLoaded, FloorIndex), DungeonPrefetch::Priority);
+	if (Handle.IsValid())
+	{
+		NextFloorHandles.Add(Handle);
+	}
+}
+
+void ADungeonManager::OnPrefetchStyleDataLoaded(int32 FloorIndex)
+{
+	if (FloorIndex != PrefetchedFloorIndex) return;
+
+	// Structural meshes (floors, walls, doors) are needed to build the rooms at all;
+	// detail meshes (clutter, furniture) are only prefetched while the budget allows
+	PrefetchStructuralMeshes.Reset();
+	PrefetchDetailMeshes.Reset();
+	PrefetchDetailCursor = 0;
+
+	for (const TSoftObjectPtr<URoomData>& RoomDataPtr : PrefetchRoomData)
+	{
+		const URoomData* RoomData = RoomDataPtr.Get();
+		if (!RoomData) continue;
+
+		if (const UFloorData* FloorData = RoomData->FloorStyleData.Get())
+		{
+			DungeonPrefetch::AddPool(FloorData->FloorTilePool, PrefetchStructuralMeshes);
+			DungeonPrefetch::AddPool(FloorData->EdgeTilePool, PrefetchStructuralMeshes);
+			DungeonPrefetch::AddPath(FloorData->DefaultFillerTile, PrefetchStructuralMeshes);
+			DungeonPrefetch::AddPool(FloorData->ClutterMeshPool, PrefetchDetailMeshes);
+		}
+
+		if (const UWallData* WallData = RoomData->WallStyleData.Get())
+		{
+			for (const FWallModule& Module : WallData->AvailableWallModules)
+			{
+				DungeonPrefetch::AddPath(Module.BaseMesh, PrefetchStructuralMeshes);
+				DungeonPrefetch::AddPath(Module.MiddleMesh, PrefetchStructuralMeshes);
+				DungeonPrefetch::AddPath(Module.TopMesh, PrefetchStructuralMeshes);
+			}
+			DungeonPrefetch::AddPath(WallData->DefaultCornerMesh, PrefetchStructuralMeshes);
+		}
+
+		if (const UDoorData* DoorData = RoomData->DoorStyleData.Get())
+		{
+			DungeonPrefetch::AddPath(DoorData->FrameSideMesh, PrefetchStructuralMeshes);
+			DungeonPrefetch::AddPath(DoorData->FrameTopMesh, PrefetchStructuralMeshes);
+		}
+
+		DungeonPrefetch::AddPool(RoomData->InteriorMeshPool, PrefetchDetailMeshes);
+	}
+
+	if (PrefetchStructuralMeshes.Num() == 0)
+	{
+		OnPrefetchStructuralLoaded(FloorIndex);
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		PrefetchStructuralMeshes, FStreamableDelegate::CreateUObject(this, &ADungeonManager::OnPrefetchStructuralLoaded, FloorIndex), DungeonPrefetch::Priority);
+	if (Handle.IsValid())
+	{
+		NextFloorHandles.Add(Handle);
+	}
+}
+
+void ADungeonManager::OnPrefetchStructuralLoaded(int32 FloorIndex)
+{
+	if (FloorIndex != PrefetchedFloorIndex) return;
+
+	bPrefetchStructuralLoaded = true;
+
+	// A floor switch was waiting on this stage; its detail meshes now load on demand
+	if (PendingFloorIndex == FloorIndex)
+	{
+		FinishFloorAdvance();
+		return;
+	}
+
+	RequestNextDetailBatch(FloorIndex);
+}
+
+void ADungeonManager::RequestNextDetailBatch(int32 FloorIndex)
+{
+	if (FloorIndex != PrefetchedFloorIndex) return;
+	if (PrefetchDetailCursor >= PrefetchDetailMeshes.Num()) return;
+
+	// 1. Budget check over everything this floor has loaded so far
+	const int64 BudgetBytes = (int64)PrefetchBudgetMB * 1024 * 1024;
+	const int64 LoadedBytes = GetLoadedMeshBytes(PrefetchStructuralMeshes)
+		+ GetLoadedMeshBytes(MakeArrayView(PrefetchDetailMeshes.GetData(), PrefetchDetailCursor));
+
+	if (LoadedBytes >= BudgetBytes)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ADungeonManager: Prefetch budget reached for floor %d (%.1f / %d MB). %d detail meshes left to load on demand."),
+			FloorIndex, LoadedBytes / (1024.0 * 1024.0), PrefetchBudgetMB, PrefetchDetailMeshes.Num() - PrefetchDetailCursor);
+		return;
+	}
+
+	// 2. Request the next batch; its completion re-enters here
+	const int32 BatchEnd = FMath::Min(PrefetchDetailCursor + DungeonPrefetch::DetailBatchSize, PrefetchDetailMeshes.Num());
+	TArray<FSoftObjectPath> BatchPaths(PrefetchDetailMeshes.GetData() + PrefetchDetailCursor, BatchEnd - PrefetchDetailCursor);
+	PrefetchDetailCursor = BatchEnd;
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		MoveTemp(BatchPaths), FStreamableDelegate::CreateUObject(this, &ADungeonManager::RequestNextDetailBatch, FloorIndex), DungeonPrefetch::Priority);
+	if (Handle.IsValid())
+	{
+		NextFloorHandles.Add(Handle);
+	}
+}
+
+int64 ADungeonManager::GetLoadedMeshBytes(TConstArrayView<FSoftObjectPath> Paths) const
+{
+	int64 TotalBytes = 0;
+	for (const FSoftObjectPath& Path : Paths)
+	{
+		if (UStaticMesh* Mesh = Cast<UStaticMesh>(Path.ResolveObject()))
+		{
+			TotalBytes += Mesh->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+	}
+	return TotalBytes;
+}
+
+void ADungeonManager::ReleaseHandles(TArray<TSharedPtr<FStreamableHandle>>& Handles)
+{
+	for (const TSharedPtr<FStreamableHandle>& Handle : Handles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->ReleaseHandle();
+		}
+	}
+	Handles.Reset();
+}
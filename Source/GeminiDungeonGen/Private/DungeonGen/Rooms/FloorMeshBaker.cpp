@@ -0,0 +1,152 @@
+﻿// FloorMeshBaker.cpp
+
+#include "DungeonGen/Rooms/FloorMeshBaker.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "MeshDescription.h"
+#include "StaticMeshAttributes.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Materials/MaterialInterface.h"
+
+bool FloorMeshBaker::CanBakeMesh(const UStaticMesh* Mesh)
+{
+	if (!Mesh) return false;
+
+	const FStaticMeshRenderData* RenderData = Mesh->GetRenderData();
+	if (!RenderData || RenderData->LODResources.Num() == 0) return false;
+
+	// Cooked builds throw away the CPU copy of vertex/index data unless the mesh opts in
+	return Mesh->bAllowCPUAccess || !FPlatformProperties::RequiresCookedData();
+}
+
+UStaticMesh* FloorMeshBaker::BuildMergedMesh(UObject* Outer, FName Name, EObjectFlags Flags, TConstArrayView<FFloorBakeInstance> Instances, bool bCommitMeshDescription)
+{
+	if (!Outer || Instances.Num() == 0) return nullptr;
+
+	FMeshDescription MeshDescription;
+	FStaticMeshAttributes Attributes(MeshDescription);
+	Attributes.Register();
+
+	TVertexAttributesRef<FVector3f> Positions = Attributes.GetVertexPositions();
+	TVertexInstanceAttributesRef<FVector3f> Normals = Attributes.GetVertexInstanceNormals();
+	TVertexInstanceAttributesRef<FVector3f> Tangents = Attributes.GetVertexInstanceTangents();
+	TVertexInstanceAttributesRef<float> BinormalSigns = Attributes.GetVertexInstanceBinormalSigns();
+	TVertexInstanceAttributesRef<FVector2f> UVs = Attributes.GetVertexInstanceUVs();
+	TPolygonGroupAttributesRef<FName> SlotNames = Attributes.GetPolygonGroupMaterialSlotNames();
+
+	// 1. Reserve up front; floors are thousands of copies of a handful of meshes
+	int32 TotalVertices = 0;
+	int32 TotalTriangles = 0;
+	for (const FFloorBakeInstance& Instance : Instances)
+	{
+		if (!CanBakeMesh(Instance.Mesh)) continue;
+		const FStaticMeshLODResources& LOD = Instance.Mesh->GetRenderData()->LODResources[0];
+		TotalVertices += LOD.GetNumVertices();
+		TotalTriangles += LOD.GetNumTriangles();
+	}
+
+	if (TotalTriangles == 0) return nullptr;
+
+	MeshDescription.ReserveNewVertices(TotalVertices);
+	MeshDescription.ReserveNewVertexInstances(TotalVertices);
+	MeshDescription.ReserveNewTriangles(TotalTriangles);
+
+	// 2. One polygon group (and material slot) per unique material
+	TMap<UMaterialInterface*, FPolygonGroupID> MaterialToGroup;
+	TArray<UMaterialInterface*> GroupMaterials;
+	TArray<FVertexInstanceID> InstanceVertexIDs;
+
+	for (const FFloorBakeInstance& Instance : Instances)
+	{
+		if (!CanBakeMesh(Instance.Mesh)) continue;
+
+		const FStaticMeshLODResources& LOD = Instance.Mesh->GetRenderData()->LODResources[0];
+		const FPositionVertexBuffer& PositionBuffer = LOD.VertexBuffers.PositionVertexBuffer;
+		const FStaticMeshVertexBuffer& VertexBuffer = LOD.VertexBuffers.StaticMeshVertexBuffer;
+		const FIndexArrayView Indices = LOD.IndexBuffer.GetArrayView();
+		const bool bFlipWinding = Instance.Transform.GetDeterminant() < 0.0f;
+
+		// A. Copy vertices into room space
+		InstanceVertexIDs.Reset(LOD.GetNumVertices());
+		for (uint32 VertIndex = 0; VertIndex < PositionBuffer.GetNumVertices(); ++VertIndex)
+		{
+			const FVertexID VertexID = MeshDescription.CreateVertex();
+			Positions[VertexID] = FVector3f(Instance.Transform.TransformPosition(FVector(PositionBuffer.VertexPosition(VertIndex))));
+
+			const FVertexInstanceID VertexInstanceID = MeshDescription.CreateVertexInstance(VertexID);
+			const FVector3f TangentX = FVector3f(Instance.Transform.TransformVectorNoScale(FVector(FVector3f(VertexBuffer.VertexTangentX(VertIndex)))));
+			const FVector4f TangentZ = VertexBuffer.VertexTangentZ(VertIndex);
+			Normals[VertexInstanceID] = FVector3f(Instance.Transform.TransformVectorNoScale(FVector(FVector3f(TangentZ))));
+			Tangents[VertexInstanceID] = TangentX;
+			BinormalSigns[VertexInstanceID] = TangentZ.W < 0.0f ? -1.0f : 1.0f;
+			UVs[VertexInstanceID] = VertexBuffer.GetVertexUV(VertIndex, 0);
+
+			InstanceVertexIDs.Add(VertexInstanceID);
+		}
+
+		// B. Copy triangles section by section into the matching material group
+		for (const FStaticMeshSection& Section : LOD.Sections)
+		{
+			UMaterialInterface* Material = Instance.Mesh->GetMaterial(Section.MaterialIndex);
+			FPolygonGroupID* GroupID = MaterialToGroup.Find(Material);
+			if (!GroupID)
+			{
+				const FPolygonGroupID NewGroupID = MeshDescription.CreatePolygonGroup();
+				SlotNames[NewGroupID] = FName(TEXT("FloorMaterial"), GroupMaterials.Num());
+				GroupMaterials.Add(Material);
+				GroupID = &MaterialToGroup.Add(Material, NewGroupID);
+			}
+
+			for (uint32 TriIndex = 0; TriIndex < Section.NumTriangles; ++TriIndex)
+			{
+				const uint32 BaseIndex = Section.FirstIndex + TriIndex * 3;
+				FVertexInstanceID Corners[3] = {
+					InstanceVertexIDs[Indices[BaseIndex + 0]],
+					InstanceVertexIDs[Indices[BaseIndex + 1]],
+					InstanceVertexIDs[Indices[BaseIndex + 2]]
+				};
+				if (bFlipWinding)
+				{
+					Swap(Corners[1], Corners[2]);
+				}
+				MeshDescription.CreateTriangle(*GroupID, MakeArrayView(Corners, 3));
+			}
+		}
+	}
+
+	// 3. Build the static mesh from the merged description
+	UStaticMesh* MergedMesh = NewObject<UStaticMesh>(Outer, Name, Flags);
+	for (int32 GroupIndex = 0; GroupIndex < GroupMaterials.Num(); ++GroupIndex)
+	{
+		const FName SlotName(TEXT("FloorMaterial"), GroupIndex);
+		MergedMesh->GetStaticMaterials().Add(FStaticMaterial(GroupMaterials[GroupIndex], SlotName, SlotName));
+	}
+
+	UStaticMesh::FBuildMeshDescriptionsParams Params;
+	Params.bBuildSimpleCollision = false;
+	Params.bCommitMeshDescription = bCommitMeshDescription;
+	Params.bFastBuild = !bCommitMeshDescription;
+
+	TArray<const FMeshDescription*> MeshDescriptions = { &MeshDescription };
+	if (!MergedMesh->BuildFromMeshDescriptions(MeshDescriptions, Params))
+	{
+		return nullptr;
+	}
+
+#if WITH_EDITOR
+	// Asset bakes keep holes for forced empty cells by colliding against the merged triangles. Runtime
+	// bakes have no collision of their own: cooking trimeshes at runtime stalls the game thread and is
+	// unavailable in cooked builds, so the room covers them with its grid boxes instead.
+	if (bCommitMeshDescription)
+	{
+		MergedMesh->CreateBodySetup();
+		if (UBodySetup* BodySetup = MergedMesh->GetBodySetup())
+		{
+			BodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+			BodySetup->CreatePhysicsMeshes();
+		}
+	}
+#endif
+
+	return MergedMesh;
+}
@@ -8,9 +8,27 @@
 #include "Data/Room/FloorData.h"
 #include "Data/Room/WallData.h"
 #include "Data/Room/DoorData.h"
+#include "DungeonGen/Rooms/FloorMeshBaker.h"
+#include "DungeonGen/Rooms/RoomCollisionBuilder.h"
+#include "DungeonGen/Manager/DungeonManager.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
 #include "UnrealClient.h"
+#include "Misc/MemStack.h"
 #include "DrawDebugHelpers.h" // Needed for debug drawing
 
+#if WITH_EDITOR
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "UObject/Package.h"
+#include "Editor.h"
+#include "TimerManager.h"
+#include "Tasks/Task.h"
+#include "Async/Async.h"
+#include "UObject/StrongObjectPtr.h"
+#endif
+
 
 
 // Sets default values
@@ -25,7 +43,10 @@ AMasterRoom::AMasterRoom()
 void AMasterRoom::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(AMasterRoom, GenerationSeed);
+	DOREPLIFETIME(AMasterRoom, RoomDataAsset);
+
+	// Always notify: a client must solve even when the server's seed matches the level's value
+	DOREPLIFETIME_CONDITION_NOTIFY(AMasterRoom, GenerationSeed, COND_None, REPNOTIFY_Always);
 }
 
 void AMasterRoom::ClearAndResetComponents()
@@ -38,14 +59,20 @@ void AMasterRoom::ClearAndResetComponents()
 			HISM->ClearInstances();
 		}
 	}
+	if (SharedInstanceManager)
+	{
+		SharedInstanceManager->RemoveSharedInstances(this);
+	}
 	
-	// 2. Reset internal grid state
-	InternalGridState.Empty();
-	if (RoomDataAsset)
+	// 2. Drop any baked floor chunks from the previous generation
+	ClearBakedFloor();
+	FloorLayerMeshes.Reset();
+	InteriorLayerMeshes.Reset();
+
+	// 3. Reset internal grid state (the solver re-sizes it for the new pass)
+	if (!RoomDataAsset)
 	{
-		int32 TotalCells = RoomDataAsset->GridSize.X * RoomDataAsset->GridSize.Y;
-		// Initialize all cells as empty before generation starts
-		InternalGridState.Init(EGridCellType::ECT_Empty, TotalCells); 
+		Layout.Empty();
 	}
 }
 
@@ -60,9 +87,11 @@ UHierarchicalInstancedStaticMeshComponent* AMasterRoom::GetOrCreateHISM(UStaticM
 	}
 	else
 	{
-		// Create a new HISM component for this unique mesh
-		FString ComponentName = FString::Printf(TEXT("HISM_%s"), *Mesh->GetName());
-		UHierarchicalInstancedStaticMeshComponent* NewHISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(this, FName(*ComponentName));
+		// Create a new HISM component for this unique mesh (auto-named: no string formatting per component),
+		// or take a released one from the manager's pool when lazily materialized
+		UHierarchicalInstancedStaticMeshComponent* NewHISM = LazyMaterializationManager
+			? LazyMaterializationManager->AcquirePooledHISM()
+			: NewObject<UHierarchicalInstancedStaticMeshComponent>(this, NAME_None);
 		
 		if (NewHISM)
 		{
@@ -88,361 +117,493 @@ FVector AMasterRoom::GetCellCenterWorldLocation(int32 X, int32 Y) const
 	);
 }
 
-// --- HELPER: Weighted Random Selection (Needs to be defined above where it's used)
-const FMeshPlacementInfo* AMasterRoom::SelectWeightedMesh(const TArray<FMeshPlacementInfo>& MeshPool, FRandomStream& Stream)
+// --- APPLY SOLVED LAYOUT ---
+void AMasterRoom::ApplyLayout()
 {
-	if (MeshPool.Num() == 0)
+	// 1. Resolve each unique mesh once. All per-call scratch comes from the mem stack.
+	FMemMark ScratchMark(FMemStack::Get());
+	const int32 NumMeshes = Layout.Meshes.Num();
+
+	TArray<UStaticMesh*, TMemStackAllocator<>> MeshAssets;
+	MeshAssets.SetNumZeroed(NumMeshes);
+	for (int32 MeshIndex = 0; MeshIndex < NumMeshes; ++MeshIndex)
 	{
-		return nullptr;
+		MeshAssets[MeshIndex] = Layout.Meshes[MeshIndex].LoadSynchronous();
 	}
 
-	// Calculate total weight
-	float TotalWeight = 0.0f;
-	for (const FMeshPlacementInfo& Info : MeshPool)
+	// 2. Counting sort of the placements by mesh, so each mesh's instances are one contiguous slice
+	TArray<int32, TMemStackAllocator<>> MeshOffsets;
+	MeshOffsets.SetNumZeroed(NumMeshes + 1);
+
+	for (const FRoomMeshPlacement& Placement : Layout.Placements)
 	{
-		TotalWeight += Info.PlacementWeight;
+		UStaticMesh* Mesh = MeshAssets[Placement.MeshIndex];
+		if (!Mesh) continue;
+
+		++MeshOffsets[Placement.MeshIndex + 1];
+
+		// Track which layer each mesh belongs to (decides what floor baking may merge)
+		if (Placement.Layer == ERoomLayer::Floor)
+		{
+			FloorLayerMeshes.Add(Mesh);
+		}
+		else if (Placement.Layer == ERoomLayer::Interior)
+		{
+			InteriorLayerMeshes.Add(Mesh);
+		}
 	}
+	for (int32 MeshIndex = 0; MeshIndex < NumMeshes; ++MeshIndex)
+	{
+		MeshOffsets[MeshIndex + 1] += MeshOffsets[MeshIndex];
+	}
+
+	// Shared HISMs belong to the manager and take world-space instances
+	const FTransform& RoomTransform = GetActorTransform();
+
+	TArray<FTransform, TMemStackAllocator<>> Transforms;
+	Transforms.SetNumUninitialized(MeshOffsets[NumMeshes]);
+	TArray<int32, TMemStackAllocator<>> WriteCursors(MeshOffsets.GetData(), NumMeshes);
 
-	if (TotalWeight <= 0.0f)
+	for (const FRoomMeshPlacement& Placement : Layout.Placements)
 	{
-		return &MeshPool[Stream.RandRange(0, MeshPool.Num() - 1)]; // Fallback to uniform random
+		if (!MeshAssets[Placement.MeshIndex]) continue;
+
+		Transforms[WriteCursors[Placement.MeshIndex]++] = SharedInstanceManager ? Placement.Transform * RoomTransform : Placement.Transform;
 	}
 
-	// Choose a random point in the total weight range
-	float RandomWeight = Stream.FRand() * TotalWeight;
-	
-	// Find which mesh corresponds to that weight point
-	float CurrentWeight = 0.0f;
-	for (const FMeshPlacementInfo& Info : MeshPool)
+	// 3. One AddInstances call per HISM instead of one AddInstance per placement.
+	//    Simplified collision replaces floor, filler and wall bodies with grid boxes; furniture keeps its own.
+	const bool bPerInstanceCollision = CollisionMode == ERoomCollisionMode::PerInstance;
+
+	// AddInstances only takes a heap TArray, so one game-thread batch outlives the call: it grows to the
+	// largest mesh slice once, then warm regenerations reuse it without allocating
+	check(IsInGameThread());
+	static TArray<FTransform> HISMBatch;
+
+	for (int32 MeshIndex = 0; MeshIndex < NumMeshes; ++MeshIndex)
 	{
-		CurrentWeight += Info.PlacementWeight;
-		if (RandomWeight <= CurrentWeight)
+		const TConstArrayView<FTransform> MeshTransforms(Transforms.GetData() + MeshOffsets[MeshIndex], MeshOffsets[MeshIndex + 1] - MeshOffsets[MeshIndex]);
+		if (!MeshAssets[MeshIndex] || MeshTransforms.Num() == 0) continue;
+
+		// Already merged into the cached floor bake of this layout
+		if (CachedBakedSourceMeshes.Contains(MeshAssets[MeshIndex])) continue;
+
+		// Collision is set before adding so disabled meshes never create instance bodies
+		const bool bCollision = bPerInstanceCollision || InteriorLayerMeshes.Contains(MeshAssets[MeshIndex]);
+		if (SharedInstanceManager)
 		{
-			return &Info;
+			SharedInstanceManager->AddSharedInstances(this, MeshAssets[MeshIndex], MeshTransforms, bCollision);
 		}
-	}
+		else if (UHierarchicalInstancedStaticMeshComponent* HISM = GetOrCreateHISM(MeshAssets[MeshIndex]))
+		{
+			HISM->SetCollisionEnabled(bCollision ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision);
 
-	return &MeshPool.Last(); // Should not be reached, but safe fallback
+			HISMBatch.Reset();
+			HISMBatch.Append(MeshTransforms.GetData(), MeshTransforms.Num());
+			HISM->AddInstances(HISMBatch, false);
+		}
+	}
 }
 
-
-// --- DESIGNER OVERRIDES: PASS 0 ---
-void AMasterRoom::ExecuteForcedPlacements(FRandomStream& Stream)
+void AMasterRoom::SetSharedInstanceManager(ADungeonManager* InManager)
 {
-	if (!RoomDataAsset) return;
+	if (SharedInstanceManager == InManager) return;
 
-	const FIntPoint GridSize = RoomDataAsset->GridSize;
-	
-	// Iterate through the map of designer-forced placements (Pass 0)
-	for (const auto& Pair : ForcedInteriorPlacements)
+	if (SharedInstanceManager)
 	{
-		const FIntPoint StartCoord = Pair.Key;
-		const FMeshPlacementInfo& MeshToPlaceInfo = Pair.Value;
-		
-		bool bCanPlace = true; // Assume placement is possible until proven otherwise
+		SharedInstanceManager->RemoveSharedInstances(this);
+	}
+	SharedInstanceManager = InManager;
 
-		// 1. Load Mesh and Check Validity
-		UStaticMesh* Mesh = MeshToPlaceInfo.MeshAsset.LoadSynchronous();
-		if (!Mesh) continue;
+	// The room's own HISMs are dead weight while the manager holds its instances
+	if (SharedInstanceManager)
+	{
+		ReleaseInstancedComponents();
+	}
+}
 
-		// 2. Select Rotation and Calculate Rotated Footprint (Uses Stream for rotation)
-		const int32 RandomRotationIndex = Stream.RandRange(0, MeshToPlaceInfo.AllowedRotations.Num() - 1);
-		const float YawRotation = (float)MeshToPlaceInfo.AllowedRotations[RandomRotationIndex];
+void AMasterRoom::ReleaseInstancedComponents()
+{
+	for (const auto& Pair : MeshToHISMMap)
+	{
+		if (!Pair.Value) continue;
 
-		FIntPoint RotatedFootprint = MeshToPlaceInfo.GridFootprint;
-		if (FMath::IsNearlyEqual(YawRotation, 90.0f) || FMath::IsNearlyEqual(YawRotation, 270.0f))
+		if (LazyMaterializationManager)
 		{
-			// Swap dimensions for 90 or 270 degree rotation
-			RotatedFootprint = FIntPoint(MeshToPlaceInfo.GridFootprint.Y, MeshToPlaceInfo.GridFootprint.X);
+			LazyMaterializationManager->ReleasePooledHISM(Pair.Value);
 		}
+		else
+		{
+			Pair.Value->DestroyComponent();
+		}
+	}
+	MeshToHISMMap.Reset();
+}
 
-		// 3. Bounds Check
-		if (StartCoord.X + RotatedFootprint.X > GridSize.X || StartCoord.Y + RotatedFootprint.Y > GridSize.Y)
+void AMasterRoom::ReleaseCollisionBox(UBoxComponent* BoxComponent)
+{
+	if (!BoxComponent) return;
+
+	if (LazyMaterializationManager)
+	{
+		LazyMaterializationManager->ReleasePooledBox(BoxComponent);
+	}
+	else
+	{
+		BoxComponent->DestroyComponent();
+	}
+}
+
+// --- LAZY MATERIALIZATION ---
+
+void AMasterRoom::SetLazyMaterialization(ADungeonManager* InManager)
+{
+	if (LazyMaterializationManager == InManager) return;
+
+	// Components go back to whoever created them before the pool changes
+	ClearAndResetComponents();
+	ReleaseInstancedComponents();
+	ClearSimplifiedCollision();
+
+	LazyMaterializationManager = InManager;
+	bMaterialized = false;
+}
+
+void AMasterRoom::Materialize()
+{
+	if (bMaterialized || !RoomDataAsset || IsRunningDedicatedServer()) return;
+
+	// Drop anything left from before the room became lazy (shared ranges, baked chunks)
+	ClearAndResetComponents();
+	MaterializeLayout(RoomDataAsset->WallStyleData.LoadSynchronous());
+}
+
+void AMasterRoom::Dematerialize()
+{
+	if (!bMaterialized) return;
+
+	ClearAndResetComponents();
+	ReleaseInstancedComponents();
+	ClearSimplifiedCollision();
+
+	// Only the solved layout stays resident
+	bMaterialized = false;
+}
+
+FBox AMasterRoom::GetLayoutBounds() const
+{
+	const FIntPoint GridSize = Layout.Grid.GetSize();
+	const FBox LocalBounds(FVector::ZeroVector, FVector(GridSize.X * CELL_SIZE, GridSize.Y * CELL_SIZE, 0.0f));
+	return LocalBounds.TransformBy(GetActorTransform());
+}
+
+void AMasterRoom::Destroyed()
+{
+	if (SharedInstanceManager)
+	{
+		SharedInstanceManager->RemoveSharedInstances(this);
+		SharedInstanceManager = nullptr;
+	}
+
+	// Pooled components belong to the manager and must not stay attached to a dead room
+	if (LazyMaterializationManager)
+	{
+		ReleaseInstancedComponents();
+		ClearSimplifiedCollision();
+		LazyMaterializationManager = nullptr;
+	}
+	Super::Destroyed();
+}
+
+void AMasterRoom::ClearBakedFloor()
+{
+	for (UStaticMeshComponent* BakedComponent : BakedFloorComponents)
+	{
+		if (BakedComponent)
 		{
-			bCanPlace = false;
+#if WITH_EDITOR
+			RemoveInstanceComponent(BakedComponent);
+#endif
+			BakedComponent->DestroyComponent();
 		}
-		
-		// 4. Overlap Check (Checks against previously placed forced items)
-		if (bCanPlace)
+	}
+	BakedFloorComponents.Reset();
+}
+
+void AMasterRoom::BuildSimplifiedCollision(float WallHeight, bool bFurnitureBoxes)
+{
+	FMemMark ScratchMark(FMemStack::Get());
+	RoomCollisionBuilder::FBoxArray Boxes;
+	RoomCollisionBuilder::BuildCollisionBoxes(Layout.Grid, FloorCollisionThickness, WallHeight, WallCollisionThickness, Boxes);
+
+	// Without HISMs each furniture piece collides as its real mesh bounds (no uniform height)
+	if (bFurnitureBoxes)
+	{
+		for (const FRoomMeshPlacement& Placement : Layout.Placements)
 		{
-			for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
+			if (Placement.Layer != ERoomLayer::Interior) continue;
+
+			if (const UStaticMesh* Mesh = Layout.Meshes[Placement.MeshIndex].LoadSynchronous())
 			{
-				for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
-				{
-					int32 FootIndex = (StartCoord.Y + FootY) * GridSize.X + (StartCoord.X + FootX);
-					
-					// If the target cell is already occupied (by another forced placement), fail.
-					if (InternalGridState.IsValidIndex(FootIndex) && InternalGridState[FootIndex] != EGridCellType::ECT_Empty)
-					{
-						bCanPlace = false;
-						break;
-					}
-				}
-				if (!bCanPlace) break;
+				Boxes.Add(Mesh->GetBoundingBox().TransformBy(Placement.Transform));
 			}
 		}
+	}
 
-		// 5. Placement and Grid Marking (Executed ONLY if all checks passed)
-		if (bCanPlace)
+	// Reuse the boxes of the previous generation; only the surplus is destroyed
+	while (CollisionBoxes.Num() > Boxes.Num())
+	{
+		ReleaseCollisionBox(CollisionBoxes.Pop());
+	}
+
+	for (int32 BoxIndex = 0; BoxIndex < Boxes.Num(); ++BoxIndex)
+	{
+		UBoxComponent* BoxComponent = CollisionBoxes.IsValidIndex(BoxIndex) ? CollisionBoxes[BoxIndex].Get() : nullptr;
+		if (!BoxComponent)
 		{
-			UHierarchicalInstancedStaticMeshComponent* HISM = GetOrCreateHISM(Mesh);
-			if (HISM)
+			BoxComponent = LazyMaterializationManager ? LazyMaterializationManager->AcquirePooledBox() : NewObject<UBoxComponent>(this);
+			BoxComponent->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+			BoxComponent->SetupAttachment(RootComponent);
+			BoxComponent->RegisterComponent();
+
+			if (CollisionBoxes.IsValidIndex(BoxIndex))
 			{
-				FVector CenterLocation = FVector(
-					(StartCoord.X + RotatedFootprint.X / 2.0f) * CELL_SIZE, 
-					(StartCoord.Y + RotatedFootprint.Y / 2.0f) * CELL_SIZE, 
-					0.0f
-				);
-				
-				FTransform InstanceTransform(FRotator(0.0f, YawRotation, 0.0f), CenterLocation);
-				HISM->AddInstance(InstanceTransform);
-				
-				for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
-				{
-					for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
-					{
-						int32 FootIndex = (StartCoord.Y + FootY) * GridSize.X + (StartCoord.X + FootX);
-						
-						if (InternalGridState.IsValidIndex(FootIndex)) 
-						{
-							InternalGridState[FootIndex] = EGridCellType::ECT_FloorMesh; 
-						}
-					}
-				}
+				CollisionBoxes[BoxIndex] = BoxComponent;
+			}
+			else
+			{
+				CollisionBoxes.Add(BoxComponent);
 			}
 		}
+
+		BoxComponent->SetRelativeLocation(Boxes[BoxIndex].GetCenter());
+		BoxComponent->SetBoxExtent(Boxes[BoxIndex].GetExtent());
 	}
 }
 
+void AMasterRoom::ClearSimplifiedCollision()
+{
+	for (UBoxComponent* BoxComponent : CollisionBoxes)
+	{
+		ReleaseCollisionBox(BoxComponent);
+	}
+	CollisionBoxes.Reset();
+}
 
-void AMasterRoom::GenerateFloorAndInterior()
+void AMasterRoom::BakeFloorLayer(bool bSaveAsAssets)
 {
-	if (!RoomDataAsset) return;
+	const float ChunkWorldSize = FMath::Max(1, FloorBakeChunkSize) * CELL_SIZE;
 
-	FRandomStream RandomStream(GenerationSeed);
-	const FIntPoint GridSize = RoomDataAsset->GridSize;
-	const UFloorData* FloorData = RoomDataAsset->FloorStyleData.LoadSynchronous();
-	
-	if (!FloorData) return;
-
-    // --- SETUP: FORCED EMPTY CELLS ---
-    for (const FIntPoint& EmptyCoord : ForcedEmptyFloorCells)
-    {
-        int32 Index = EmptyCoord.Y * GridSize.X + EmptyCoord.X;
-        if (InternalGridState.IsValidIndex(Index) && InternalGridState[Index] == EGridCellType::ECT_Empty)
-        {
-            // Mark cell as reserved/empty (Red/Cyan in debug view)
-            InternalGridState[Index] = EGridCellType::ECT_Wall; 
-        }
-    }
-    
-    // --- PASS 0: DESIGNER OVERRIDES: FORCED PLACEMENTS ---
-    ExecuteForcedPlacements(RandomStream);
-    
-    // --- PASS 1: WEIGHTED AND LARGE MESH PLACEMENT (With Edge Constraint) ---
-	for (int32 Y = 0; Y < GridSize.Y; ++Y)
+	// 1. Collect floor-only instances, bucketed by chunk
+	TMap<FIntPoint, TArray<FFloorBakeInstance>> Chunks;
+	TArray<UHierarchicalInstancedStaticMeshComponent*> BakedHISMs;
+	TArray<TObjectPtr<UStaticMesh>> BakedSourceMeshes;
+
+	for (UStaticMesh* Mesh : FloorLayerMeshes)
 	{
-		for (int32 X = 0; X < GridSize.X; ++X)
+		UHierarchicalInstancedStaticMeshComponent* HISM = MeshToHISMMap.FindRef(Mesh);
+		if (!HISM || HISM->GetInstanceCount() == 0) continue;
+
+		// A HISM shared with furniture can't be emptied without losing the furniture instances
+		if (InteriorLayerMeshes.Contains(Mesh))
 		{
-			const int32 Index = Y * GridSize.X + X;
-			
-			// Skip if already occupied by a forced item or reserved empty space
-			if (InternalGridState[Index] != EGridCellType::ECT_Empty)
-			{
-				continue;
-			}
-			
-            // --- NEW EDGE CONSTRAINT LOGIC ---
-            const TArray<FMeshPlacementInfo>* ActiveMeshPool = &FloorData->FloorTilePool;
-            const bool bIsOnEdge = 
-                (X == 0 || X == GridSize.X - 1 || 
-                 Y == 0 || Y == GridSize.Y - 1);
-
-            if (bIsOnEdge && FloorData->EdgeTilePool.Num() > 0)
-            {
-                ActiveMeshPool = &FloorData->EdgeTilePool;
-            }
-
-            // A. Weighted Random Selection
-			const FMeshPlacementInfo* MeshToPlaceInfo = SelectWeightedMesh(*ActiveMeshPool, RandomStream);
-			
-			if (!MeshToPlaceInfo) continue;
-			UStaticMesh* Mesh = MeshToPlaceInfo->MeshAsset.LoadSynchronous();
-			if (!Mesh) continue;
+			UE_LOG(LogTemp, Warning, TEXT("AMasterRoom: %s is used by floor and interior pools; leaving it on HISM."), *Mesh->GetName());
+			continue;
+		}
 
-			bool bCanPlace = true;
+		if (!FloorMeshBaker::CanBakeMesh(Mesh))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("AMasterRoom: %s needs bAllowCPUAccess to be baked at runtime; leaving it on HISM."), *Mesh->GetName());
+			continue;
+		}
 
-			// B. Select Rotation and Calculate Rotated Footprint
-			const int32 RandomRotationIndex = RandomStream.RandRange(0, MeshToPlaceInfo->AllowedRotations.Num() - 1);
-			const float YawRotation = (float)MeshToPlaceInfo->AllowedRotations[RandomRotationIndex];
+		for (int32 InstanceIndex = 0; InstanceIndex < HISM->GetInstanceCount(); ++InstanceIndex)
+		{
+			FTransform InstanceTransform;
+			HISM->GetInstanceTransform(InstanceIndex, InstanceTransform, false);
 
-			FIntPoint RotatedFootprint = MeshToPlaceInfo->GridFootprint;
-			if (FMath::IsNearlyEqual(YawRotation, 90.0f) || FMath::IsNearlyEqual(YawRotation, 270.0f))
-			{
-				RotatedFootprint = FIntPoint(MeshToPlaceInfo->GridFootprint.Y, MeshToPlaceInfo->GridFootprint.X);
-			}
+			const FIntPoint ChunkCoord(
+				FMath::FloorToInt32(InstanceTransform.GetLocation().X / ChunkWorldSize),
+				FMath::FloorToInt32(InstanceTransform.GetLocation().Y / ChunkWorldSize)
+			);
+			Chunks.FindOrAdd(ChunkCoord).Add({ Mesh, InstanceTransform });
+		}
+		BakedHISMs.Add(HISM);
+		BakedSourceMeshes.Add(Mesh);
+	}
 
-			// C. Bounds and Occupancy Check
-            // ... (Bounds and Occupancy checks remain the same, using RotatedFootprint) ...
-            
-            if (X + RotatedFootprint.X > GridSize.X || Y + RotatedFootprint.Y > GridSize.Y)
-			{
-				bCanPlace = false;
-			}
-            
-            if (bCanPlace)
-			{
-				for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
-				{
-					for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
-					{
-						int32 FootIndex = (Y + FootY) * GridSize.X + (X + FootX);
-						if (InternalGridState.IsValidIndex(FootIndex) && InternalGridState[FootIndex] != EGridCellType::ECT_Empty)
-						{
-							bCanPlace = false;
-							break;
-						}
-					}
-					if (!bCanPlace) break;
-				}
-			}
+	if (Chunks.Num() == 0) return;
+
+	ClearBakedFloor();
+	TArray<TObjectPtr<UStaticMesh>> MergedMeshes;
+
+	// 2. Merge each chunk into one mesh and give it a plain static mesh component
+	for (const auto& Pair : Chunks)
+	{
+		UObject* MeshOuter = this;
+		FName MeshName = NAME_None;
+		EObjectFlags MeshFlags = RF_Transient;
 
+#if WITH_EDITOR
+		UPackage* Package = nullptr;
+		if (bSaveAsAssets)
+		{
+			const FString AssetName = FString::Printf(TEXT("SM_%s_Floor_%d_%d"), *GetName(), Pair.Key.X, Pair.Key.Y);
+			Package = CreatePackage(*FString::Printf(TEXT("/Game/DungeonGen/Baked/%s/%s"), *GetName(), *AssetName));
+			MeshName = FName(*AssetName);
+			MeshFlags = RF_Public | RF_Standalone;
 
-			// D. Placement and Grid Marking
-			if (bCanPlace)
+			// Re-baking replaces the previous asset of the same chunk
+			if (UStaticMesh* Existing = FindObject<UStaticMesh>(Package, *AssetName))
 			{
-				UHierarchicalInstancedStaticMeshComponent* HISM = GetOrCreateHISM(Mesh);
-				if (HISM)
-				{
-					FVector CenterLocation = FVector(
-						(X + RotatedFootprint.X / 2.0f) * CELL_SIZE, 
-						(Y + RotatedFootprint.Y / 2.0f) * CELL_SIZE, 
-						0.0f
-					);
-					
-					FTransform InstanceTransform(FRotator(0.0f, YawRotation, 0.0f), CenterLocation);
-					HISM->AddInstance(InstanceTransform);
-					
-					for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
-					{
-						for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
-						{
-							int32 FootIndex = (Y + FootY) * GridSize.X + (X + FootX);
-                            // Mark as occupied
-							InternalGridState[FootIndex] = EGridCellType::ECT_FloorMesh; 
-						}
-					}
-				}
+				Existing->ClearFlags(RF_Public | RF_Standalone);
+				Existing->Rename(nullptr, GetTransientPackage(), REN_DontCreateRedirectors | REN_NonTransactional);
 			}
+			MeshOuter = Package;
 		}
-	}
+#endif
 
+		UStaticMesh* MergedMesh = FloorMeshBaker::BuildMergedMesh(MeshOuter, MeshName, MeshFlags, Pair.Value, bSaveAsAssets);
+		if (!MergedMesh)
+		{
+			// Keep the HISM path intact rather than rendering a half-baked floor
+			UE_LOG(LogTemp, Warning, TEXT("AMasterRoom: Floor bake failed for chunk (%d, %d); keeping HISM floor."), Pair.Key.X, Pair.Key.Y);
+			ClearBakedFloor();
+			return;
+		}
 
-    // --- PASS 2: GAP FILLING WITH DEFAULT 1x1 TILE ---
-    
-    UStaticMesh* FillerMesh = FloorData->DefaultFillerTile.LoadSynchronous();
-    if (FillerMesh)
-    {
-        UHierarchicalInstancedStaticMeshComponent* HISM = GetOrCreateHISM(FillerMesh);
-        
-        for (int32 Y = 0; Y < GridSize.Y; ++Y)
-        {
-            for (int32 X = 0; X < GridSize.X; ++X)
-            {
-                int32 Index = Y * GridSize.X + X;
-                
-                // Only place if the cell is still completely empty
-                if (InternalGridState[Index] == EGridCellType::ECT_Empty)
-                {
-                    FVector CenterLocation = FVector(
-                        (X + 0.5f) * CELL_SIZE, 
-                        (Y + 0.5f) * CELL_SIZE, 
-                        0.0f
-                    );
-                    
-                    FTransform InstanceTransform(FRotator::ZeroRotator, CenterLocation);
-                    HISM->AddInstance(InstanceTransform);
-                    
-                    // Mark cell as occupied
-                    InternalGridState[Index] = EGridCellType::ECT_FloorMesh; 
-                }
-            }
-        }
-    }
-}
-
-void AMasterRoom::GenerateWallsAndDoors()
-{
-	if (!RoomDataAsset) return;
-	
-	const FIntPoint GridSize = RoomDataAsset->GridSize;
-	const UWallData* WallData = RoomDataAsset->WallStyleData.LoadSynchronous();
-	
-	if (!WallData) return;
+#if WITH_EDITOR
+		if (Package)
+		{
+			FAssetRegistryModule::AssetCreated(MergedMesh);
+			Package->MarkPackageDirty();
+		}
+#endif
+
+		MergedMeshes.Add(MergedMesh);
+		AddBakedFloorComponent(MergedMesh, bSaveAsAssets);
+	}
 
-	// --- Corner Placement ---
-	if (UStaticMesh* CornerMesh = WallData->DefaultCornerMesh.LoadSynchronous())
+	// 3. The baked chunks now own the floor; drop the per-instance data
+	for (UHierarchicalInstancedStaticMeshComponent* HISM : BakedHISMs)
 	{
-		UHierarchicalInstancedStaticMeshComponent* HISM = GetOrCreateHISM(CornerMesh);
-		if (HISM)
-		{
-			// Note: Placed at grid vertices (0,0), (LengthX, 0), etc. using BackBottomCenter pivot assumption.
-			
-			const float LengthX = GridSize.X * CELL_SIZE;
-			const float LengthY = GridSize.Y * CELL_SIZE;
+		HISM->ClearInstances();
+	}
 
-			// A. Corner (0, 0)
-			HISM->AddInstance(FTransform(FRotator(0, 0, 0), GetActorLocation()));
-			
-			// B. Corner (LengthX, 0)
-			HISM->AddInstance(FTransform(FRotator(0, 90.0f, 0), GetActorLocation() + FVector(LengthX, 0.0f, 0.0f)));
+	// 4. Runtime bakes are kept with the layout, so rematerializing the room only re-creates components
+	if (!bSaveAsAssets)
+	{
+		CachedBakedFloorMeshes = MoveTemp(MergedMeshes);
+		CachedBakedSourceMeshes = MoveTemp(BakedSourceMeshes);
+	}
+}
 
-			// C. Corner (0, LengthY)
-			HISM->AddInstance(FTransform(FRotator(0, -90.0f, 0), GetActorLocation() + FVector(0.0f, LengthY, 0.0f)));
-			
-			// D. Corner (LengthX, LengthY)
-			HISM->AddInstance(FTransform(FRotator(0, 180.0f, 0), GetActorLocation() + FVector(LengthX, LengthY, 0.0f)));
-		}
+void AMasterRoom::AddBakedFloorComponent(UStaticMesh* MergedMesh, bool bSaveAsAssets)
+{
+	UStaticMeshComponent* BakedComponent = NewObject<UStaticMeshComponent>(this, NAME_None, bSaveAsAssets ? RF_NoFlags : RF_Transient);
+	BakedComponent->SetStaticMesh(MergedMesh);
+
+	// Runtime bakes have no collision (the room's floor boxes cover them); saved bakes collide
+	// complex-as-simple unless the simplified boxes already cover the floor
+	if (!bSaveAsAssets || CollisionMode == ERoomCollisionMode::Simplified)
+	{
+		BakedComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	}
-	
-	// --- Next Implementation: Door Reservation and 1D Wall Packing ---
+	BakedComponent->SetupAttachment(RootComponent);
+	BakedComponent->RegisterComponent();
+#if WITH_EDITOR
+	if (bSaveAsAssets)
+	{
+		// Saved with the level so the baked assets stay referenced
+		AddInstanceComponent(BakedComponent);
+	}
+#endif
+	BakedFloorComponents.Add(BakedComponent);
+}
+
+void AMasterRoom::ResetFloorBakeCache()
+{
+	CachedBakedFloorMeshes.Reset();
+	CachedBakedSourceMeshes.Reset();
 }
 
 void AMasterRoom::RegenerateRoom()
 {
-	// Server Check: Only the server or the editor should run generation
+	// Server Check: Only the server or the editor should run generation (clients follow the replicated seed)
 	if (GetLocalRole() != ROLE_Authority && !IsEditorOnly() && !GIsEditor)
 	{
 		return;
 	}
 
+	GenerateLayout(true);
+}
+
+void AMasterRoom::OnRep_GenerationSeed()
+{
+	// The solver is deterministic, so the client rebuilds the server's layout from the seed alone
+	GenerateLayout(false);
+}
+
+void AMasterRoom::GenerateLayout(bool bRerunConstructionScripts)
+{
 	if (!RoomDataAsset)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("ADungeonMasterRoom: RoomDataAsset is null. Cannot generate."));
 		return;
 	}
 	
+#if WITH_EDITOR
+	// A synchronous regenerate supersedes any preview still solving
+	CancelPreviewSolve(true);
+#endif
+
 	// 1. Clean up and prepare for a new generation pass
 	ClearAndResetComponents();
 
-	// 2. Run generation steps
-	GenerateFloorAndInterior();
-	GenerateWallsAndDoors();
-	
-	// 3. Force bounding box updates on all new and existing components
-	for (const auto& Pair : MeshToHISMMap)
+	// 2. Solve the layout, then spawn its instances
+	FRoomSolverInput SolverInput;
+	SolverInput.RoomData = RoomDataAsset;
+	SolverInput.FloorData = RoomDataAsset->FloorStyleData.LoadSynchronous();
+	SolverInput.WallData = RoomDataAsset->WallStyleData.LoadSynchronous();
+	SolverInput.Seed = GenerationSeed;
+	SolverInput.ForcedEmptyFloorCells = ForcedEmptyFloorCells;
+	SolverInput.ForcedInteriorPlacements = &ForcedInteriorPlacements;
+	SolverInput.bGridOnly = IsRunningDedicatedServer();
+
+	FRoomLayoutSolver::GetForCurrentThread().Solve(SolverInput, Layout);
+	FinishGeneration(SolverInput.WallData, bRerunConstructionScripts);
+}
+
+void AMasterRoom::FinishGeneration(const UWallData* WallData, bool bRerunConstructionScripts)
+{
+	// A new layout was just solved; a floor bake of the previous one no longer matches
+	ResetFloorBakeCache();
+
+	// Dedicated servers never render: no HISMs, instance transforms or debug drawing, only the grid
+	// boxes. Clients on Simplified collide with the same floor and wall boxes.
+	if (IsRunningDedicatedServer())
 	{
-		if (UHierarchicalInstancedStaticMeshComponent* HISM = Pair.Value)
+		if (CollisionMode != ERoomCollisionMode::Simplified)
 		{
-			// Forces the component to re-evaluate its spatial boundaries based on new instances
-			HISM->UpdateBounds(); 
-			HISM->MarkRenderStateDirty(); // Ensures the rendering thread picks up the change
+			UE_LOG(LogTemp, Warning, TEXT("AMasterRoom: %s uses per-instance collision; the dedicated server collides with simplified boxes, so clients may diverge."), *GetName());
 		}
+		BuildSimplifiedCollision(WallData ? WallData->WallHeight : 0.0f, true);
+		return;
+	}
+
+	// Lazy rooms keep only the layout until the manager finds a player in range;
+	// a room that is already materialized is rebuilt straight away
+	if (!LazyMaterializationManager || bMaterialized)
+	{
+		MaterializeLayout(WallData);
 	}
 
 	// In Editor, this is the most reliable way to force a complete bounds update on the actor
 #if WITH_EDITOR
-	RerunConstructionScripts();
+	if (bRerunConstructionScripts)
+	{
+		RerunConstructionScripts();
+	}
 #endif
 	
 	// 4. Update the debug visuals immediately
@@ -452,6 +613,266 @@ void AMasterRoom::RegenerateRoom()
 	}
 }
 
+void AMasterRoom::MaterializeLayout(const UWallData* WallData)
+{
+	// The cached bake is only valid while this room still bakes into its own components
+	if (!bBakeFloorAfterGeneration || SharedInstanceManager)
+	{
+		ResetFloorBakeCache();
+	}
+
+	ApplyLayout();
+
+	// Optional: collapse the static floor into merged chunks
+	if (bBakeFloorAfterGeneration)
+	{
+		if (SharedInstanceManager)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("AMasterRoom: Floor baking is skipped while the dungeon manager shares instanced meshes."));
+		}
+		else if (CachedBakedFloorMeshes.Num() > 0)
+		{
+			// Back in range with the same layout: reuse the merged meshes, only the components are new
+			for (UStaticMesh* MergedMesh : CachedBakedFloorMeshes)
+			{
+				AddBakedFloorComponent(MergedMesh, false);
+			}
+		}
+		else
+		{
+			BakeFloorLayer(false);
+		}
+	}
+
+	// Runtime floor bakes carry no collision, so even per-instance rooms need the floor slabs then
+	// (no wall boxes: the wall HISMs still collide per instance)
+	if (CollisionMode == ERoomCollisionMode::Simplified)
+	{
+		BuildSimplifiedCollision(WallData ? WallData->WallHeight : 0.0f, false);
+	}
+	else if (BakedFloorComponents.Num() > 0)
+	{
+		BuildSimplifiedCollision(0.0f, false);
+	}
+	else
+	{
+		ClearSimplifiedCollision();
+	}
+	
+	// 3. Force bounding box updates on all new and existing components
+	for (const auto& Pair : MeshToHISMMap)
+	{
+		if (UHierarchicalInstancedStaticMeshComponent* HISM = Pair.Value)
+		{
+			// Forces the component to re-evaluate its spatial boundaries based on new instances
+			HISM->UpdateBounds(); 
+			HISM->MarkRenderStateDirty(); // Ensures the rendering thread picks up the change
+		}
+	}
+
+	bMaterialized = true;
+}
+
+// --- GAMEPLAY GRID QUERIES ---
+
+bool AMasterRoom::WorldToCell(const FVector& WorldLocation, FIntPoint& OutCell) const
+{
+	const FVector LocalLocation = GetActorTransform().InverseTransformPosition(WorldLocation);
+	OutCell = FIntPoint(
+		FMath::FloorToInt32(LocalLocation.X / CELL_SIZE),
+		FMath::FloorToInt32(LocalLocation.Y / CELL_SIZE)
+	);
+	return Layout.Grid.IsValidCell(OutCell.X, OutCell.Y);
+}
+
+FVector AMasterRoom::CellToWorld(const FIntPoint& Cell) const
+{
+	return GetActorTransform().TransformPosition(FVector(
+		(Cell.X + 0.5f) * CELL_SIZE, 
+		(Cell.Y + 0.5f) * CELL_SIZE, 
+		0.0f
+	));
+}
+
+EGridCellType AMasterRoom::GetCellTypeAtLocation(const FVector& WorldLocation) const
+{
+	FIntPoint Cell;
+	if (!WorldToCell(WorldLocation, Cell))
+	{
+		return EGridCellType::ECT_Empty;
+	}
+	return Layout.Grid.Get(Layout.Grid.ToIndex(Cell.X, Cell.Y));
+}
+
+bool AMasterRoom::IsCellFree(const FIntPoint& Cell) const
+{
+	if (!Layout.Grid.IsValidCell(Cell.X, Cell.Y)) return false;
+
+	return Layout.IsCellFree(Layout.Grid.ToIndex(Cell.X, Cell.Y));
+}
+
+bool AMasterRoom::IsAreaFree(const FIntPoint& Min, const FIntPoint& Footprint) const
+{
+	for (int32 FootY = 0; FootY < Footprint.Y; ++FootY)
+	{
+		for (int32 FootX = 0; FootX < Footprint.X; ++FootX)
+		{
+			if (!IsCellFree(FIntPoint(Min.X + FootX, Min.Y + FootY)))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool AMasterRoom::FindRandomFreeCell(const FIntPoint& Footprint, FRandomStream& Stream, FIntPoint& OutCell, FVector& OutWorldLocation) const
+{
+	const FIntPoint GridSize = Layout.Grid.GetSize();
+	if (Footprint.X <= 0 || Footprint.Y <= 0 || Footprint.X > GridSize.X || Footprint.Y > GridSize.Y) return false;
+
+	// Not enough free cells left anywhere for this footprint: skip the sampling and the scan
+	if (Layout.NumFreeCells < Footprint.X * Footprint.Y) return false;
+
+	// Single cells are sampled straight from the free-cell index
+	if (Footprint == FIntPoint(1, 1))
+	{
+		const TArray<int32>& FreeCells = Layout.GetFreeCellIndices();
+		if (FreeCells.Num() == 0) return false;
+
+		const int32 Index = FreeCells[Stream.RandRange(0, FreeCells.Num() - 1)];
+		OutCell = FIntPoint(Index % GridSize.X, Index / GridSize.X);
+		OutWorldLocation = CellToWorld(OutCell);
+		return true;
+	}
+
+	const int32 RangeX = GridSize.X - Footprint.X + 1;
+	const int32 RangeY = GridSize.Y - Footprint.Y + 1;
+	bool bFound = false;
+
+	// 1. Rejection sampling: O(1) expected attempts on a mostly free floor
+	static constexpr int32 MaxRandomAttempts = 32;
+	for (int32 Attempt = 0; Attempt < MaxRandomAttempts && !bFound; ++Attempt)
+	{
+		OutCell = FIntPoint(Stream.RandRange(0, RangeX - 1), Stream.RandRange(0, RangeY - 1));
+		bFound = IsAreaFree(OutCell, Footprint);
+	}
+
+	// 2. Crowded room: scan every start position once, beginning at a random one
+	if (!bFound)
+	{
+		const int32 NumStarts = RangeX * RangeY;
+		const int32 FirstStart = Stream.RandRange(0, NumStarts - 1);
+		for (int32 Step = 0; Step < NumStarts && !bFound; ++Step)
+		{
+			const int32 StartIndex = (FirstStart + Step) % NumStarts;
+			OutCell = FIntPoint(StartIndex % RangeX, StartIndex / RangeX);
+			bFound = IsAreaFree(OutCell, Footprint);
+		}
+	}
+
+	if (bFound)
+	{
+		OutWorldLocation = GetActorTransform().TransformPosition(FVector(
+			(OutCell.X + Footprint.X / 2.0f) * CELL_SIZE, 
+			(OutCell.Y + Footprint.Y / 2.0f) * CELL_SIZE, 
+			0.0f
+		));
+	}
+	return bFound;
+}
+
+bool AMasterRoom::FindNearestFreeCell(const FVector& WorldLocation, int32 MaxRadius, FIntPoint& OutCell, FVector& OutWorldLocation) const
+{
+	FIntPoint Origin;
+	WorldToCell(WorldLocation, Origin);
+
+	const FVector LocalLocation = GetActorTransform().InverseTransformPosition(WorldLocation);
+	bool bFound = false;
+	double BestDistSq = TNumericLimits<double>::Max();
+
+	auto TestCell = [&](int32 X, int32 Y)
+	{
+		if (!IsCellFree(FIntPoint(X, Y))) return;
+
+		const double DistSq = FVector2D::DistSquared(
+			FVector2D(LocalLocation.X, LocalLocation.Y),
+			FVector2D((X + 0.5) * CELL_SIZE, (Y + 0.5) * CELL_SIZE)
+		);
+		if (DistSq < BestDistSq)
+		{
+			BestDistSq = DistSq;
+			OutCell = FIntPoint(X, Y);
+			bFound = true;
+		}
+	};
+
+	// Expand square rings around the origin. A ring-r cell center is at least (r - 0.5) cells from any
+	// point in the origin cell, so a later ring can still beat a corner of the first ring with a hit:
+	// stop only once the ring lies farther out than the best distance found.
+	for (int32 Radius = 0; Radius <= MaxRadius; ++Radius)
+	{
+		if (bFound && Radius * CELL_SIZE > FMath::Sqrt(BestDistSq) + 0.5 * CELL_SIZE) break;
+
+		if (Radius == 0)
+		{
+			TestCell(Origin.X, Origin.Y);
+			continue;
+		}
+
+		for (int32 Offset = -Radius; Offset <= Radius; ++Offset)
+		{
+			TestCell(Origin.X + Offset, Origin.Y - Radius);
+			TestCell(Origin.X + Offset, Origin.Y + Radius);
+		}
+		for (int32 Offset = -Radius + 1; Offset < Radius; ++Offset)
+		{
+			TestCell(Origin.X - Radius, Origin.Y + Offset);
+			TestCell(Origin.X + Radius, Origin.Y + Offset);
+		}
+	}
+
+	if (bFound)
+	{
+		OutWorldLocation = CellToWorld(OutCell);
+	}
+	return bFound;
+}
+
+void AMasterRoom::ForEachCellInBox(const FBox& WorldBox, TFunctionRef<void(const FIntPoint& Cell, EGridCellType Type)> Visitor) const
+{
+	const FIntPoint GridSize = Layout.Grid.GetSize();
+	if (!WorldBox.IsValid || GridSize.X <= 0 || GridSize.Y <= 0) return;
+
+	const FBox LocalBox = WorldBox.InverseTransformBy(GetActorTransform());
+	const int32 MinX = FMath::Max(0, FMath::FloorToInt32(LocalBox.Min.X / CELL_SIZE));
+	const int32 MinY = FMath::Max(0, FMath::FloorToInt32(LocalBox.Min.Y / CELL_SIZE));
+	const int32 MaxX = FMath::Min(GridSize.X - 1, FMath::FloorToInt32(LocalBox.Max.X / CELL_SIZE));
+	const int32 MaxY = FMath::Min(GridSize.Y - 1, FMath::FloorToInt32(LocalBox.Max.Y / CELL_SIZE));
+
+	for (int32 Y = MinY; Y <= MaxY; ++Y)
+	{
+		for (int32 X = MinX; X <= MaxX; ++X)
+		{
+			Visitor(FIntPoint(X, Y), Layout.Grid.Get(Layout.Grid.ToIndex(X, Y)));
+		}
+	}
+}
+
+void AMasterRoom::GetCellsInBox(const FBox& WorldBox, TArray<FIntPoint>& OutCells) const
+{
+	OutCells.Reset();
+	ForEachCellInBox(WorldBox, [&OutCells](const FIntPoint& Cell, EGridCellType Type)
+	{
+		OutCells.Add(Cell);
+	});
+}
+
+void AMasterRoom::BuildWalkableMask(FGridBitMask& OutMask) const
+{
+	Layout.BuildWalkableMask(OutMask);
+}
+
 void AMasterRoom::DrawDebugGrid()
 {
 	if (!RoomDataAsset) return;
@@ -486,7 +907,7 @@ void AMasterRoom::DrawDebugGrid()
 		for (int32 X = 0; X < GridSize.X; ++X)
 		{
 			int32 Index = Y * GridSize.X + X;
-			if (InternalGridState.IsValidIndex(Index))
+			if (Layout.Grid.IsValidIndex(Index))
 			{
 				// Center of the cell
 				FVector Center = ActorLocation + FVector(
@@ -498,7 +919,7 @@ void AMasterRoom::DrawDebugGrid()
 				// Size of the box (half extent)
 				FVector Extent(CELL_SIZE / 2.0f, CELL_SIZE / 2.0f, 20.0f);
 				
-				FColor BoxColor = (InternalGridState[Index] != EGridCellType::ECT_Empty) ? FColor::Red : FColor::Blue;
+				FColor BoxColor = (Layout.Grid.Get(Index) != EGridCellType::ECT_Empty) ? FColor::Red : FColor::Blue;
 
 				DrawDebugBox(World, Center, Extent, FQuat::Identity, BoxColor, false, 5.0f, 0, 3.0f);
 			}
@@ -512,16 +933,26 @@ void AMasterRoom::DrawDebugGrid()
 void AMasterRoom::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
-	FName PropertyName = (PropertyChangedEvent.Property != nullptr) ? PropertyChangedEvent.Property->GetFName() : NAME_None;
+	// Member name, so edits inside arrays and maps (forced cells/placements) are caught too
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
 
 	if (PropertyName == GET_MEMBER_NAME_CHECKED(AMasterRoom, bGenerateRoom))
 	{
 		if (bGenerateRoom)
 		{
-			RegenerateRoom();
-			bGenerateRoom = false; // Reset the button immediately after execution
+			bGenerateRoom = false; // Reset the button immediately
+			RequestPreviewRegeneration();
 		}
 	}
+	else if (bAutoRegeneratePreview && (
+		PropertyName == GET_MEMBER_NAME_CHECKED(AMasterRoom, RoomDataAsset) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(AMasterRoom, GenerationSeed) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(AMasterRoom, ForcedEmptyFloorCells) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(AMasterRoom, ForcedInteriorPlacements) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(AMasterRoom, CollisionMode)))
+	{
+		RequestPreviewRegeneration();
+	}
 	
 	// IMPORTANT: Call the debug drawing here so it updates instantly in the editor
 	if (GIsEditor)
@@ -529,6 +960,224 @@ void AMasterRoom::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedE
 		DrawDebugGrid();
 	}
 }
+
+void AMasterRoom::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		RegisterPreviewRoom(this);
+	}
+}
+
+void AMasterRoom::BeginDestroy()
+{
+	UnregisterPreviewRoom(this);
+
+	if (GEditor)
+	{
+		GEditor->GetTimerManager()->ClearTimer(PreviewDebounceHandle);
+	}
+	CancelPreviewSolve(true);
+
+	Super::BeginDestroy();
+}
+
+// --- BACKGROUND PREVIEW ---
+
+// One in-flight preview solve. Owns copies of the room's own inputs, so only the data assets are
+// shared with the game thread; edits to them are fenced by OnPreObjectPropertyChanged. The snapshot
+// holds its assets strongly, so a cancelled task that is still winding down never reads collected
+// assets after the room has moved on to other ones (the strong pointers are safe to drop on a worker).
+struct FRoomPreviewSolve
+{
+	TArray<FIntPoint> ForcedEmptyFloorCells;
+	TMap<FIntPoint, FMeshPlacementInfo> ForcedInteriorPlacements;
+
+	TStrongObjectPtr<URoomData> RoomData;
+	TStrongObjectPtr<UFloorData> FloorData;
+	TStrongObjectPtr<UWallData> WallData;
+
+	FRoomSolverInput Input;
+	FRoomLayoutSolver Solver;
+	FRoomLayout Layout;
+
+	std::atomic<bool> bCancelled { false };
+	UE::Tasks::FTask Task;
+};
+
+bool AMasterRoom::IsPreviewSource(const UObject* Object) const
+{
+	return Object && RoomDataAsset && (
+		Object == RoomDataAsset ||
+		Object == RoomDataAsset->FloorStyleData.Get() ||
+		Object == RoomDataAsset->WallStyleData.Get());
+}
+
+namespace MasterRoomPreview
+{
+	// Editor rooms that follow their data assets, behind one registration of the global delegates
+	static TArray<TWeakObjectPtr<AMasterRoom>> Rooms;
+	static FDelegateHandle PreObjectPropertyChangedHandle;
+	static FDelegateHandle ObjectPropertyChangedHandle;
+
+	static bool IsStyleAsset(const UObject* Object)
+	{
+		return Object && (Object->IsA<URoomData>() || Object->IsA<UFloorData>() || Object->IsA<UWallData>());
+	}
+}
+
+void AMasterRoom::RegisterPreviewRoom(AMasterRoom* Room)
+{
+	using namespace MasterRoomPreview;
+
+	if (Rooms.Num() == 0)
+	{
+		PreObjectPropertyChangedHandle = FCoreUObjectDelegates::OnPreObjectPropertyChanged.AddStatic(&AMasterRoom::OnPreObjectPropertyChanged);
+		ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddStatic(&AMasterRoom::OnObjectPropertyChanged);
+	}
+	Rooms.AddUnique(Room);
+}
+
+void AMasterRoom::UnregisterPreviewRoom(AMasterRoom* Room)
+{
+	using namespace MasterRoomPreview;
+
+	if (Rooms.RemoveSwap(Room) == 0 || Rooms.Num() > 0) return;
+
+	FCoreUObjectDelegates::OnPreObjectPropertyChanged.Remove(PreObjectPropertyChangedHandle);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+}
+
+void AMasterRoom::OnPreObjectPropertyChanged(UObject* Object, const FEditPropertyChain& PropertyChain)
+{
+	if (!MasterRoomPreview::IsStyleAsset(Object)) return;
+
+	// The solve reads the data asset directly; stop it before the edit lands
+	for (const TWeakObjectPtr<AMasterRoom>& WeakRoom : MasterRoomPreview::Rooms)
+	{
+		AMasterRoom* Room = WeakRoom.Get();
+		if (Room && Room->IsPreviewSource(Object))
+		{
+			Room->CancelPreviewSolve(true);
+		}
+	}
+}
+
+void AMasterRoom::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (!MasterRoomPreview::IsStyleAsset(Object)) return;
+
+	for (const TWeakObjectPtr<AMasterRoom>& WeakRoom : MasterRoomPreview::Rooms)
+	{
+		AMasterRoom* Room = WeakRoom.Get();
+		if (Room && Room->bAutoRegeneratePreview && Room->IsPreviewSource(Object))
+		{
+			Room->RequestPreviewRegeneration();
+		}
+	}
+}
+
+void AMasterRoom::RequestPreviewRegeneration()
+{
+	// Outside the editor world (PIE, commandlets) there is nothing to keep interactive
+	UWorld* World = GetWorld();
+	if (!GEditor || !World || World->WorldType != EWorldType::Editor)
+	{
+		RegenerateRoom();
+		return;
+	}
+
+	// The pending result is already stale
+	CancelPreviewSolve(false);
+
+	// A zero rate would clear the timer instead of setting it
+	GEditor->GetTimerManager()->SetTimer(PreviewDebounceHandle, FTimerDelegate::CreateUObject(this, &AMasterRoom::StartPreviewSolve), FMath::Max(PreviewDebounceSeconds, 0.01f), false);
+}
+
+void AMasterRoom::StartPreviewSolve()
+{
+	if (!RoomDataAsset) return;
+
+	CancelPreviewSolve(false);
+
+	// 1. Snapshot the inputs on the game thread
+	TSharedRef<FRoomPreviewSolve> PreviewSolve = MakeShared<FRoomPreviewSolve>();
+	PreviewSolve->ForcedEmptyFloorCells = ForcedEmptyFloorCells;
+	PreviewSolve->ForcedInteriorPlacements = ForcedInteriorPlacements;
+
+	PreviewSolve->RoomData.Reset(RoomDataAsset);
+	PreviewSolve->FloorData.Reset(RoomDataAsset->FloorStyleData.LoadSynchronous());
+	PreviewSolve->WallData.Reset(RoomDataAsset->WallStyleData.LoadSynchronous());
+
+	FRoomSolverInput& SolverInput = PreviewSolve->Input;
+	SolverInput.RoomData = PreviewSolve->RoomData.Get();
+	SolverInput.FloorData = PreviewSolve->FloorData.Get();
+	SolverInput.WallData = PreviewSolve->WallData.Get();
+	SolverInput.Seed = GenerationSeed;
+	SolverInput.ForcedEmptyFloorCells = PreviewSolve->ForcedEmptyFloorCells;
+	SolverInput.ForcedInteriorPlacements = &PreviewSolve->ForcedInteriorPlacements;
+	SolverInput.CancelFlag = &PreviewSolve->bCancelled;
+
+	ActivePreviewSolve = PreviewSolve;
+
+	// 2. Solve on a worker, then hand the finished layout back to the game thread
+	TWeakObjectPtr<AMasterRoom> WeakRoom(this);
+	PreviewSolve->Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [PreviewSolve, WeakRoom]()
+	{
+		if (!PreviewSolve->Solver.Solve(PreviewSolve->Input, PreviewSolve->Layout))
+		{
+			return;
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [PreviewSolve, WeakRoom]()
+		{
+			if (AMasterRoom* Room = WeakRoom.Get())
+			{
+				Room->ApplyPreviewSolve(PreviewSolve);
+			}
+		});
+	});
+}
+
+void AMasterRoom::ApplyPreviewSolve(const TSharedRef<FRoomPreviewSolve>& PreviewSolve)
+{
+	// Superseded by a newer edit or a synchronous regenerate
+	if (ActivePreviewSolve.Get() != &PreviewSolve.Get() || PreviewSolve->bCancelled) return;
+
+	const UWallData* WallData = PreviewSolve->Input.WallData;
+	ActivePreviewSolve.Reset();
+
+	// Only the finished placement set touches components
+	ClearAndResetComponents();
+	Swap(Layout, PreviewSolve->Layout);
+	FinishGeneration(WallData, false);
+}
+
+void AMasterRoom::CancelPreviewSolve(bool bWait)
+{
+	if (!ActivePreviewSolve.IsValid()) return;
+
+	ActivePreviewSolve->bCancelled = true;
+	if (bWait && ActivePreviewSolve->Task.IsValid())
+	{
+		// Cancellation is checked per row, so this returns quickly
+		ActivePreviewSolve->Task.Wait();
+	}
+	ActivePreviewSolve.Reset();
+}
+
+void AMasterRoom::BakeFloorToAssets()
+{
+	// Regenerate without the runtime bake so the floor HISMs hold the full layout
+	{
+		TGuardValue<bool> SkipRuntimeBake(bBakeFloorAfterGeneration, false);
+		RegenerateRoom();
+	}
+	BakeFloorLayer(true);
+}
+
 void AMasterRoom::PostLoad()
 {
 	Super::PostLoad();
@@ -0,0 +1,129 @@
+// RoomCollisionBuilder.cpp
+
+#include "DungeonGen/Rooms/RoomCollisionBuilder.h"
+#include "Data/Grid/CompactRoomGrid.h"
+
+void RoomCollisionBuilder::BuildRects(const FIntPoint& Size, TFunctionRef<bool(int32 Index)> IsSolid, FRectArray& OutRects)
+{
+	OutRects.Reset();
+
+	TBitArray<TMemStackAllocator<>> Covered(false, Size.X * Size.Y);
+
+	auto IsOpen = [&Size, &Covered, &IsSolid](int32 X, int32 Y)
+	{
+		const int32 Index = Y * Size.X + X;
+		return !Covered[Index] && IsSolid(Index);
+	};
+
+	for (int32 Y = 0; Y < Size.Y; ++Y)
+	{
+		for (int32 X = 0; X < Size.X; ++X)
+		{
+			if (!IsOpen(X, Y)) continue;
+
+			// 1. Grow right along the row
+			int32 MaxX = X + 1;
+			while (MaxX < Size.X && IsOpen(MaxX, Y))
+			{
+				++MaxX;
+			}
+
+			// 2. Grow down while the whole span of the next row is open
+			int32 MaxY = Y + 1;
+			for (; MaxY < Size.Y; ++MaxY)
+			{
+				bool bRowOpen = true;
+				for (int32 SpanX = X; SpanX < MaxX && bRowOpen; ++SpanX)
+				{
+					bRowOpen = IsOpen(SpanX, MaxY);
+				}
+				if (!bRowOpen) break;
+			}
+
+			// 3. Claim the rectangle
+			for (int32 RectY = Y; RectY < MaxY; ++RectY)
+			{
+				Covered.SetRange(RectY * Size.X + X, MaxX - X, true);
+			}
+			OutRects.Add(FIntRect(X, Y, MaxX, MaxY));
+		}
+	}
+}
+
+void RoomCollisionBuilder::BuildFloorRects(const FCompactRoomGrid& Grid, FRectArray& OutRects)
+{
+	// Only cells that actually get a floor mesh (or a doorway threshold) are solid. Forced empty cells
+	// are reserved as ECT_Wall by the solver and must stay holes, so "not empty" is not enough here.
+	BuildRects(Grid.GetSize(), [&Grid](int32 Index)
+	{
+		const EGridCellType Type = Grid.Get(Index);
+		return Type == EGridCellType::ECT_FloorMesh || Type == EGridCellType::ECT_Doorway;
+	}, OutRects);
+}
+
+void RoomCollisionBuilder::BuildCollisionBoxes(const FCompactRoomGrid& Grid, float FloorThickness, float WallHeight, float WallThickness, FBoxArray& OutBoxes)
+{
+	OutBoxes.Reset();
+
+	// 1. Floor slabs
+	FRectArray FloorRects;
+	BuildFloorRects(Grid, FloorRects);
+
+	for (const FIntRect& Rect : FloorRects)
+	{
+		OutBoxes.Add(FBox(
+			FVector(Rect.Min.X * CELL_SIZE, Rect.Min.Y * CELL_SIZE, -FloorThickness),
+			FVector(Rect.Max.X * CELL_SIZE, Rect.Max.Y * CELL_SIZE, 0.0f)
+		));
+	}
+
+	const FIntPoint Size = Grid.GetSize();
+	if (WallHeight <= 0.0f || Size.X <= 0 || Size.Y <= 0) return;
+
+	// 2. Perimeter walls: one box per straight run, broken at doorway cells.
+	//    Walls sit on the grid boundary, matching the corner placement in the solver.
+	const float HalfThickness = WallThickness * 0.5f;
+
+	auto AddRuns = [&](int32 Length, TFunctionRef<int32(int32)> CellIndexAt, TFunctionRef<FBox(int32, int32)> MakeBox)
+	{
+		int32 RunStart = 0;
+		for (int32 Step = 0; Step <= Length; ++Step)
+		{
+			const bool bBreak = Step == Length || Grid.Get(CellIndexAt(Step)) == EGridCellType::ECT_Doorway;
+			if (!bBreak) continue;
+
+			if (Step > RunStart)
+			{
+				OutBoxes.Add(MakeBox(RunStart, Step));
+			}
+			RunStart = Step + 1;
+		}
+	};
+
+	const float LengthX = Size.X * CELL_SIZE;
+	const float LengthY = Size.Y * CELL_SIZE;
+
+	// A. South (Y = 0) and North (Y = LengthY) edges
+	for (const int32 EdgeRow : { 0, Size.Y - 1 })
+	{
+		const float EdgeY = EdgeRow == 0 ? 0.0f : LengthY;
+		AddRuns(Size.X,
+			[&Grid, EdgeRow](int32 Step) { return Grid.ToIndex(Step, EdgeRow); },
+			[=](int32 Start, int32 End)
+			{
+				return FBox(FVector(Start * CELL_SIZE, EdgeY - HalfThickness, 0.0f), FVector(End * CELL_SIZE, EdgeY + HalfThickness, WallHeight));
+			});
+	}
+
+	// B. West (X = 0) and East (X = LengthX) edges
+	for (const int32 EdgeColumn : { 0, Size.X - 1 })
+	{
+		const float EdgeX = EdgeColumn == 0 ? 0.0f : LengthX;
+		AddRuns(Size.Y,
+			[&Grid, EdgeColumn](int32 Step) { return Grid.ToIndex(EdgeColumn, Step); },
+			[=](int32 Start, int32 End)
+			{
+				return FBox(FVector(EdgeX - HalfThickness, Start * CELL_SIZE, 0.0f), FVector(EdgeX + HalfThickness, End * CELL_SIZE, WallHeight));
+			});
+	}
+}
@@ -0,0 +1,778 @@
+﻿// RoomLayoutSolver.cpp
+
+#include "DungeonGen/Rooms/RoomLayoutSolver.h"
+#include "Data/Room/RoomData.h"
+#include "Data/Room/FloorData.h"
+#include "Data/Room/WallData.h"
+#include "Misc/MemStack.h"
+#include "HAL/MemoryBase.h"
+
+#if !UE_BUILD_SHIPPING
+namespace RoomSolverAllocations
+{
+	// Set once the proxy is installed; the counters are only touched by their own thread
+	static std::atomic<bool> bEnabled { false };
+	static thread_local int32 SolveDepth = 0;
+	static thread_local int32 NumAllocations = 0;
+
+	FORCEINLINE void Note(SIZE_T Count)
+	{
+		if (SolveDepth > 0 && Count > 0)
+		{
+			++NumAllocations;
+		}
+	}
+
+	// Forwards everything to the allocator it wraps; outside a solve the only cost is one TLS read
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { Note(Count); return Inner->Malloc(Count, Alignment); }
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { Note(Count); return Inner->TryMalloc(Count, Alignment); }
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override { Note(Count); return Inner->Realloc(Original, Count, Alignment); }
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override { Note(Count); return Inner->TryRealloc(Original, Count, Alignment); }
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUsedOnCurrentThread() override { Inner->MarkTLSCachesAsUsedOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUnusedOnCurrentThread() override { Inner->MarkTLSCachesAsUnusedOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+		virtual void OnMallocInitialized() override { Inner->OnMallocInitialized(); }
+		virtual void OnPreFork() override { Inner->OnPreFork(); }
+		virtual void OnPostFork() override { Inner->OnPostFork(); }
+
+	private:
+		FMalloc* Inner;
+	};
+
+	// Counts the allocations of one Solve (nested solves on the same thread count once, in the outer one)
+	struct FScopedCount
+	{
+		explicit FScopedCount(int32& InOutResult) : Result(InOutResult), Before(NumAllocations) { ++SolveDepth; }
+		~FScopedCount()
+		{
+			--SolveDepth;
+			Result = bEnabled ? NumAllocations - Before : INDEX_NONE;
+		}
+
+		int32& Result;
+		int32 Before;
+	};
+}
+#endif
+
+// --- FRoomLayout ---
+
+void FRoomLayout::Reset(const FIntPoint& GridSize)
+{
+	// Initialize all cells as empty before generation starts
+	Grid.Init(GridSize, EGridCellType::ECT_Empty);
+	InteriorOccupancy.Init(false, Grid.Num());
+	Meshes.Reset();
+	Placements.Reset();
+	NumFillerTiles = 0;
+	NumFreeCells = 0;
+	FreeCellIndices.Reset();
+	bFreeCellIndicesBuilt = false;
+}
+
+void FRoomLayout::Empty()
+{
+	Grid.Empty();
+	InteriorOccupancy.Empty();
+	Meshes.Empty();
+	Placements.Empty();
+	NumFillerTiles = 0;
+	NumFreeCells = 0;
+	FreeCellIndices.Empty();
+	bFreeCellIndicesBuilt = false;
+}
+
+int32 FRoomLayout::AddMesh(const TSoftObjectPtr<UStaticMesh>& Mesh)
+{
+	// Pools hold a handful of meshes, a linear search beats hashing soft paths
+	const int32 Existing = Meshes.IndexOfByKey(Mesh);
+	return Existing != INDEX_NONE ? Existing : Meshes.Add(Mesh);
+}
+
+bool FRoomLayout::IsCellFree(int32 Index) const
+{
+	return Grid.IsValidIndex(Index)
+		&& Grid.Get(Index) == EGridCellType::ECT_FloorMesh
+		&& !(InteriorOccupancy.IsValidIndex(Index) && InteriorOccupancy[Index]);
+}
+
+void FRoomLayout::UpdateNumFreeCells()
+{
+	NumFreeCells = 0;
+	for (int32 Index = 0; Index < Grid.Num(); ++Index)
+	{
+		NumFreeCells += IsCellFree(Index) ? 1 : 0;
+	}
+}
+
+const TArray<int32>& FRoomLayout::GetFreeCellIndices() const
+{
+	if (!bFreeCellIndicesBuilt)
+	{
+		FreeCellIndices.Reset(NumFreeCells);
+		for (int32 Index = 0; Index < Grid.Num(); ++Index)
+		{
+			if (IsCellFree(Index))
+			{
+				FreeCellIndices.Add(Index);
+			}
+		}
+		bFreeCellIndicesBuilt = true;
+	}
+	return FreeCellIndices;
+}
+
+void FRoomLayout::BuildWalkableMask(FGridBitMask& OutMask) const
+{
+	const FIntPoint GridSize = Grid.GetSize();
+	OutMask.Init(GridSize, false);
+	if (Grid.Num() == 0) return;
+
+	FMemMark ScratchMark(FMemStack::Get());
+
+	// 1. Flat free-cell bits, 64 per word: floor cells of each packed grid word minus the matching
+	//    occupancy word (both hold 32 cells per word, aligned on the same flat indices)
+	const uint32* OccupancyWords = InteriorOccupancy.Num() == Grid.Num() ? InteriorOccupancy.GetData() : nullptr;
+	const int32 NumGridWords = Grid.NumWords();
+
+	TArray<uint64, TMemStackAllocator<>> FreeBits;
+	FreeBits.SetNumZeroed((NumGridWords + 1) / 2 + 1); // One spare word for the row windows below
+
+	for (int32 WordIndex = 0; WordIndex < NumGridWords; ++WordIndex)
+	{
+		uint32 Bits = Grid.GetTypeBits(WordIndex, EGridCellType::ECT_FloorMesh);
+		if (OccupancyWords)
+		{
+			Bits &= ~OccupancyWords[WordIndex];
+		}
+		FreeBits[WordIndex >> 1] |= (uint64)Bits << ((WordIndex & 1) * 32);
+	}
+
+	// 2. Copy each row's 64-cell windows into the row-aligned mask words (padding bits stay 0)
+	for (int32 Y = 0; Y < GridSize.Y; ++Y)
+	{
+		uint64* RowWords = OutMask.GetRowData(Y);
+		for (int32 X = 0; X < GridSize.X; X += 64)
+		{
+			const int64 BitIndex = (int64)Y * GridSize.X + X;
+			const int32 Shift = (int32)(BitIndex & 63);
+			const int64 FlatWord = BitIndex >> 6;
+
+			uint64 Window = FreeBits[FlatWord] >> Shift;
+			if (Shift != 0)
+			{
+				Window |= FreeBits[FlatWord + 1] << (64 - Shift);
+			}
+
+			const int32 NumBits = FMath::Min(64, GridSize.X - X);
+			if (NumBits < 64)
+			{
+				Window &= ((uint64)1 << NumBits) - 1;
+			}
+			RowWords[X >> 6] = Window;
+		}
+	}
+}
+
+// --- FRoomLayoutSolver ---
+
+bool FRoomLayoutSolver::Solve(const FRoomSolverInput& InInput, FRoomLayout& OutLayout)
+{
+	if (!InInput.RoomData) return false;
+
+#if !UE_BUILD_SHIPPING
+	// Declared before the mark so popping it is counted too
+	RoomSolverAllocations::FScopedCount AllocationCount(NumHeapAllocationsInLastSolve);
+#endif
+
+	Input = &InInput;
+	Layout = &OutLayout;
+	GridSize = InInput.RoomData->GridSize;
+	Stream.Initialize(InInput.Seed);
+
+	// Pass temporaries are carved from the thread's mem stack and released together at the end
+	FMemMark ScratchMark(FMemStack::Get());
+
+	// 1. Clean up and prepare for a new generation pass
+	Layout->Reset(GridSize);
+
+	// 2. Run generation steps (long passes also check for cancellation per row)
+	if (Input->FloorData)
+	{
+		ExecuteForcedPlacements();
+		GenerateFloor();
+		if (!IsCancelled())
+		{
+			GenerateInteriorFurniture();
+		}
+	}
+	if (!IsCancelled())
+	{
+		GenerateWallsAndDoors();
+		Layout->UpdateNumFreeCells();
+	}
+
+	const bool bCompleted = !IsCancelled();
+	Input = nullptr;
+	Layout = nullptr;
+	return bCompleted;
+}
+
+FRoomLayoutSolver& FRoomLayoutSolver::GetForCurrentThread()
+{
+	static thread_local FRoomLayoutSolver ThreadSolver;
+	return ThreadSolver;
+}
+
+bool FRoomLayoutSolver::EnableAllocationCounting()
+{
+#if !UE_BUILD_SHIPPING
+	check(IsInGameThread());
+	if (!RoomSolverAllocations::bEnabled)
+	{
+		// Leaked on purpose: other threads may still call through the pointer they read earlier
+		GMalloc = new RoomSolverAllocations::FCountingMalloc(GMalloc);
+		RoomSolverAllocations::bEnabled = true;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+// --- HELPER: Weighted Random Selection
+const FMeshPlacementInfo* FRoomLayoutSolver::SelectWeightedMesh(const TArray<FMeshPlacementInfo>& MeshPool, FRandomStream& Stream)
+{
+	if (MeshPool.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// Calculate total weight
+	float TotalWeight = 0.0f;
+	for (const FMeshPlacementInfo& Info : MeshPool)
+	{
+		TotalWeight += Info.PlacementWeight;
+	}
+
+	if (TotalWeight <= 0.0f)
+	{
+		return &MeshPool[Stream.RandRange(0, MeshPool.Num() - 1)]; // Fallback to uniform random
+	}
+
+	// Choose a random point in the total weight range
+	float RandomWeight = Stream.FRand() * TotalWeight;
+
+	// Find which mesh corresponds to that weight point
+	float CurrentWeight = 0.0f;
+	for (const FMeshPlacementInfo& Info : MeshPool)
+	{
+		CurrentWeight += Info.PlacementWeight;
+		if (RandomWeight <= CurrentWeight)
+		{
+			return &Info;
+		}
+	}
+
+	return &MeshPool.Last(); // Should not be reached, but safe fallback
+}
+
+FIntPoint FRoomLayoutSolver::GetRotatedFootprint(const FMeshPlacementInfo& Info, float YawRotation)
+{
+	if (FMath::IsNearlyEqual(YawRotation, 90.0f) || FMath::IsNearlyEqual(YawRotation, 270.0f))
+	{
+		// Swap dimensions for 90 or 270 degree rotation
+		return FIntPoint(Info.GridFootprint.Y, Info.GridFootprint.X);
+	}
+	return Info.GridFootprint;
+}
+
+void FRoomLayoutSolver::AddPlacement(const TSoftObjectPtr<UStaticMesh>& Mesh, const FIntPoint& Start, const FIntPoint& Footprint, float YawRotation, ERoomLayer Layer)
+{
+	if (Input->bGridOnly && Layer != ERoomLayer::Interior) return;
+
+	FVector CenterLocation = FVector(
+		(Start.X + Footprint.X / 2.0f) * CELL_SIZE,
+		(Start.Y + Footprint.Y / 2.0f) * CELL_SIZE,
+		0.0f
+	);
+
+	FRoomMeshPlacement& Placement = Layout->Placements.AddDefaulted_GetRef();
+	Placement.MeshIndex = Layout->AddMesh(Mesh);
+	Placement.Transform = FTransform(FRotator(0.0f, YawRotation, 0.0f), CenterLocation);
+	Placement.Layer = Layer;
+}
+
+// --- DESIGNER OVERRIDES: PASS 0 ---
+void FRoomLayoutSolver::ExecuteForcedPlacements()
+{
+	FCompactRoomGrid& Grid = Layout->Grid;
+
+	// --- SETUP: FORCED EMPTY CELLS ---
+	for (const FIntPoint& EmptyCoord : Input->ForcedEmptyFloorCells)
+	{
+		int32 Index = EmptyCoord.Y * GridSize.X + EmptyCoord.X;
+		if (Grid.IsValidIndex(Index) && Grid.Get(Index) == EGridCellType::ECT_Empty)
+		{
+			// Mark cell as reserved/empty (Red/Cyan in debug view)
+			Grid.Set(Index, EGridCellType::ECT_Wall);
+		}
+	}
+
+	if (!Input->ForcedInteriorPlacements) return;
+
+	// Iterate through the map of designer-forced placements (Pass 0)
+	for (const auto& Pair : *Input->ForcedInteriorPlacements)
+	{
+		const FIntPoint StartCoord = Pair.Key;
+		const FMeshPlacementInfo& MeshToPlaceInfo = Pair.Value;
+
+		bool bCanPlace = true; // Assume placement is possible until proven otherwise
+
+		// 1. Check Mesh Validity
+		if (MeshToPlaceInfo.MeshAsset.IsNull()) continue;
+
+		// 2. Select Rotation and Calculate Rotated Footprint (Uses Stream for rotation)
+		const int32 RandomRotationIndex = Stream.RandRange(0, MeshToPlaceInfo.AllowedRotations.Num() - 1);
+		const float YawRotation = (float)MeshToPlaceInfo.AllowedRotations[RandomRotationIndex];
+		const FIntPoint RotatedFootprint = GetRotatedFootprint(MeshToPlaceInfo, YawRotation);
+
+		// 3. Bounds Check
+		if (StartCoord.X + RotatedFootprint.X > GridSize.X || StartCoord.Y + RotatedFootprint.Y > GridSize.Y)
+		{
+			bCanPlace = false;
+		}
+
+		// 4. Overlap Check (Checks against previously placed forced items)
+		if (bCanPlace)
+		{
+			for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
+			{
+				for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
+				{
+					int32 FootIndex = (StartCoord.Y + FootY) * GridSize.X + (StartCoord.X + FootX);
+
+					// If the target cell is already occupied (by another forced placement), fail.
+					if (Grid.IsValidIndex(FootIndex) && Grid.Get(FootIndex) != EGridCellType::ECT_Empty)
+					{
+						bCanPlace = false;
+						break;
+					}
+				}
+				if (!bCanPlace) break;
+			}
+		}
+
+		// 5. Placement and Grid Marking (Executed ONLY if all checks passed)
+		if (bCanPlace)
+		{
+			AddPlacement(MeshToPlaceInfo.MeshAsset, StartCoord, RotatedFootprint, YawRotation, ERoomLayer::Interior);
+
+			for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
+			{
+				for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
+				{
+					int32 FootIndex = (StartCoord.Y + FootY) * GridSize.X + (StartCoord.X + FootX);
+
+					if (Grid.IsValidIndex(FootIndex))
+					{
+						Grid.Set(FootIndex, EGridCellType::ECT_FloorMesh);
+						Layout->InteriorOccupancy[FootIndex] = true;
+					}
+				}
+			}
+		}
+	}
+}
+
+void FRoomLayoutSolver::GenerateFloor()
+{
+	const UFloorData* FloorData = Input->FloorData;
+	FCompactRoomGrid& Grid = Layout->Grid;
+
+	// --- PASS 1: WEIGHTED AND LARGE MESH PLACEMENT (With Edge Constraint) ---
+	const bool bSolvedByWFC = FloorData->SolverMode == EFloorSolverMode::WaveFunctionCollapse && GenerateFloorWFC();
+
+	for (int32 Y = 0; Y < GridSize.Y && !bSolvedByWFC; ++Y)
+	{
+		if (IsCancelled()) return;
+
+		for (int32 X = 0; X < GridSize.X; ++X)
+		{
+			const int32 Index = Y * GridSize.X + X;
+
+			// Skip if already occupied by a forced item or reserved empty space
+			if (Grid.Get(Index) != EGridCellType::ECT_Empty)
+			{
+				continue;
+			}
+
+			// --- EDGE CONSTRAINT LOGIC ---
+			const TArray<FMeshPlacementInfo>* ActiveMeshPool = &FloorData->FloorTilePool;
+			const bool bIsOnEdge =
+				(X == 0 || X == GridSize.X - 1 ||
+				 Y == 0 || Y == GridSize.Y - 1);
+
+			if (bIsOnEdge && FloorData->EdgeTilePool.Num() > 0)
+			{
+				ActiveMeshPool = &FloorData->EdgeTilePool;
+			}
+
+			// A. Weighted Random Selection
+			const FMeshPlacementInfo* MeshToPlaceInfo = SelectWeightedMesh(*ActiveMeshPool, Stream);
+
+			if (!MeshToPlaceInfo) continue;
+			if (MeshToPlaceInfo->MeshAsset.IsNull()) continue;
+
+			bool bCanPlace = true;
+
+			// B. Select Rotation and Calculate Rotated Footprint
+			const int32 RandomRotationIndex = Stream.RandRange(0, MeshToPlaceInfo->AllowedRotations.Num() - 1);
+			const float YawRotation = (float)MeshToPlaceInfo->AllowedRotations[RandomRotationIndex];
+			const FIntPoint RotatedFootprint = GetRotatedFootprint(*MeshToPlaceInfo, YawRotation);
+
+			// C. Bounds and Occupancy Check
+			if (X + RotatedFootprint.X > GridSize.X || Y + RotatedFootprint.Y > GridSize.Y)
+			{
+				bCanPlace = false;
+			}
+
+			if (bCanPlace)
+			{
+				for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
+				{
+					for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
+					{
+						int32 FootIndex = (Y + FootY) * GridSize.X + (X + FootX);
+						if (Grid.IsValidIndex(FootIndex) && Grid.Get(FootIndex) != EGridCellType::ECT_Empty)
+						{
+							bCanPlace = false;
+							break;
+						}
+					}
+					if (!bCanPlace) break;
+				}
+			}
+
+			// D. Placement and Grid Marking
+			if (bCanPlace)
+			{
+				AddPlacement(MeshToPlaceInfo->MeshAsset, FIntPoint(X, Y), RotatedFootprint, YawRotation, ERoomLayer::Floor);
+
+				for (int32 FootY = 0; FootY < RotatedFootprint.Y; ++FootY)
+				{
+					for (int32 FootX = 0; FootX < RotatedFootprint.X; ++FootX)
+					{
+						int32 FootIndex = (Y + FootY) * GridSize.X + (X + FootX);
+						// Mark as occupied
+						Grid.Set(FootIndex, EGridCellType::ECT_FloorMesh);
+					}
+				}
+			}
+		}
+	}
+
+	// --- PASS 2: GAP FILLING WITH DEFAULT 1x1 TILE ---
+	if (!FloorData->DefaultFillerTile.IsNull())
+	{
+		const int32 FillerMeshIndex = Input->bGridOnly ? INDEX_NONE : Layout->AddMesh(FloorData->DefaultFillerTile);
+
+		for (int32 Y = 0; Y < GridSize.Y; ++Y)
+		{
+			if (IsCancelled()) return;
+
+			for (int32 X = 0; X < GridSize.X; ++X)
+			{
+				int32 Index = Y * GridSize.X + X;
+
+				// Only place if the cell is still completely empty
+				if (Grid.Get(Index) == EGridCellType::ECT_Empty)
+				{
+					if (FillerMeshIndex != INDEX_NONE)
+					{
+						FVector CenterLocation = FVector(
+							(X + 0.5f) * CELL_SIZE,
+							(Y + 0.5f) * CELL_SIZE,
+							0.0f
+						);
+
+						FRoomMeshPlacement& Placement = Layout->Placements.AddDefaulted_GetRef();
+						Placement.MeshIndex = FillerMeshIndex;
+						Placement.Transform = FTransform(FRotator::ZeroRotator, CenterLocation);
+						Placement.Layer = ERoomLayer::Floor;
+					}
+					++Layout->NumFillerTiles;
+
+					// Mark cell as occupied
+					Grid.Set(Index, EGridCellType::ECT_FloorMesh);
+				}
+			}
+		}
+	}
+}
+
+// --- PASS 1 (WFC): ADJACENCY-CONSTRAINED 1x1 TILES ---
+bool FRoomLayoutSolver::GenerateFloorWFC()
+{
+	const UFloorData* FloorData = Input->FloorData;
+	FCompactRoomGrid& Grid = Layout->Grid;
+
+	// 1. Tile set: the 1x1 entries of the floor and edge pools (at most 64, one bit each)
+	TArray<const FMeshPlacementInfo*, TInlineAllocator<FWaveFunctionCollapseSolver::MaxTiles>> Tiles;
+	uint64 FloorMask = 0;
+	uint64 EdgeMask = 0;
+
+	auto AddPool = [&Tiles](const TArray<FMeshPlacementInfo>& Pool, uint64& OutMask)
+	{
+		for (const FMeshPlacementInfo& Info : Pool)
+		{
+			if (Info.MeshAsset.IsNull() || Info.PlacementWeight <= 0.0f || Info.GridFootprint != FIntPoint(1, 1)) continue;
+
+			if (Tiles.Num() == FWaveFunctionCollapseSolver::MaxTiles)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("FRoomLayoutSolver: WFC supports %d tiles; the rest are ignored."), FWaveFunctionCollapseSolver::MaxTiles);
+				return;
+			}
+			OutMask |= (uint64)1 << Tiles.Add(&Info);
+		}
+	};
+	AddPool(FloorData->FloorTilePool, FloorMask);
+	AddPool(FloorData->EdgeTilePool, EdgeMask);
+
+	// Same rule as Pass 1: without edge tiles the perimeter uses the main pool
+	if (EdgeMask == 0)
+	{
+		EdgeMask = FloorMask;
+	}
+	if (EdgeMask == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FRoomLayoutSolver: WFC needs 1x1 floor tiles; using the weighted pass."));
+		return false;
+	}
+
+	// 2. Symmetric compatibility masks from the tag rules
+	auto Allows = [](const FMeshPlacementInfo& Tile, const FMeshPlacementInfo& Neighbour)
+	{
+		return Tile.AllowedNeighbourTags.Num() == 0 || Tile.AllowedNeighbourTags.Contains(Neighbour.TileTag);
+	};
+
+	TArray<float, TInlineAllocator<FWaveFunctionCollapseSolver::MaxTiles>> Weights;
+	TArray<uint64, TInlineAllocator<FWaveFunctionCollapseSolver::MaxTiles>> Compatible;
+	Compatible.AddZeroed(Tiles.Num());
+
+	for (int32 TileA = 0; TileA < Tiles.Num(); ++TileA)
+	{
+		Weights.Add(Tiles[TileA]->PlacementWeight);
+		for (int32 TileB = 0; TileB < Tiles.Num(); ++TileB)
+		{
+			if (Allows(*Tiles[TileA], *Tiles[TileB]) && Allows(*Tiles[TileB], *Tiles[TileA]))
+			{
+				Compatible[TileA] |= (uint64)1 << TileB;
+			}
+		}
+	}
+
+	// 3. Initial domains: only cells still empty after Pass 0 take part
+	WFCDomains.SetNumUninitialized(Grid.Num(), EAllowShrinking::No);
+	for (int32 Y = 0; Y < GridSize.Y; ++Y)
+	{
+		for (int32 X = 0; X < GridSize.X; ++X)
+		{
+			const int32 Index = Y * GridSize.X + X;
+			const bool bIsOnEdge = (X == 0 || X == GridSize.X - 1 || Y == 0 || Y == GridSize.Y - 1);
+			WFCDomains[Index] = Grid.Get(Index) == EGridCellType::ECT_Empty ? (bIsOnEdge ? EdgeMask : FloorMask) : 0;
+		}
+	}
+
+	if (!WFCSolver.Solve(GridSize, Weights, Compatible, WFCDomains, Stream, FloorData->WFCMaxBacktracks, Input->CancelFlag))
+	{
+		if (!IsCancelled())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FRoomLayoutSolver: WFC found no floor after %d backtracks; using the weighted pass."), WFCSolver.GetNumBacktracks());
+		}
+		return false;
+	}
+
+	// 4. One placement per collapsed cell
+	for (int32 Index = 0; Index < WFCDomains.Num(); ++Index)
+	{
+		if (WFCDomains[Index] == 0) continue;
+
+		const FMeshPlacementInfo& Info = *Tiles[FMath::CountTrailingZeros64(WFCDomains[Index])];
+		const float YawRotation = Info.AllowedRotations.Num() > 0
+			? (float)Info.AllowedRotations[Stream.RandRange(0, Info.AllowedRotations.Num() - 1)]
+			: 0.0f;
+
+		AddPlacement(Info.MeshAsset, FIntPoint(Index % GridSize.X, Index / GridSize.X), FIntPoint(1, 1), YawRotation, ERoomLayer::Floor);
+		Grid.Set(Index, EGridCellType::ECT_FloorMesh);
+	}
+	return true;
+}
+
+// --- PASS 3: LARGE INTERIOR FURNITURE (MaxRects Packing) ---
+void FRoomLayoutSolver::GenerateInteriorFurniture()
+{
+	const URoomData* RoomData = Input->RoomData;
+	const TArray<FMeshPlacementInfo>& InteriorPool = RoomData->InteriorMeshPool;
+	if (InteriorPool.Num() == 0 || RoomData->InteriorFillRatio <= 0.0f) return;
+
+	const FCompactRoomGrid& Grid = Layout->Grid;
+	TBitArray<>& InteriorOccupancy = Layout->InteriorOccupancy;
+	const int32 TotalCells = Grid.Num();
+
+	// 1. Furniture may only stand on floor cells that no forced placement already covers.
+	//    Forced empty cells are reserved as ECT_Wall, so they are blocked here as well.
+	PackerBlockedCells.Init(false, TotalCells);
+	int32 FreeCells = 0;
+	for (int32 Index = 0; Index < TotalCells; ++Index)
+	{
+		const bool bBlocked = Grid.Get(Index) != EGridCellType::ECT_FloorMesh || InteriorOccupancy[Index];
+		PackerBlockedCells[Index] = bBlocked;
+		FreeCells += bBlocked ? 0 : 1;
+	}
+
+	Packer.Init(GridSize, PackerBlockedCells);
+
+	// 2. Build the candidate list (scratch, released with Solve's mem mark)
+	TArray<int32, TMemStackAllocator<>> Candidates;
+	for (int32 PoolIndex = 0; PoolIndex < InteriorPool.Num(); ++PoolIndex)
+	{
+		const FMeshPlacementInfo& Info = InteriorPool[PoolIndex];
+		if (Info.PlacementWeight <= 0.0f || Info.GridFootprint.X <= 0 || Info.GridFootprint.Y <= 0 || Info.AllowedRotations.Num() == 0)
+		{
+			continue;
+		}
+
+		if (!Info.MeshAsset.IsNull())
+		{
+			Candidates.Add(PoolIndex);
+		}
+	}
+
+	// 3. Pack until the fill target is met or nothing fits any more. Free space only shrinks,
+	//    so a mesh that fits in no rotation is dropped for good instead of being retried.
+	const int32 TargetCells = FMath::FloorToInt32(FreeCells * RoomData->InteriorFillRatio);
+	int32 CoveredCells = 0;
+
+	while (CoveredCells < TargetCells && Candidates.Num() > 0 && !IsCancelled())
+	{
+		// A. Weighted pick among the remaining candidates
+		float TotalWeight = 0.0f;
+		for (const int32 PoolIndex : Candidates)
+		{
+			TotalWeight += InteriorPool[PoolIndex].PlacementWeight;
+		}
+
+		const float RandomWeight = Stream.FRand() * TotalWeight;
+		int32 CandidateIndex = Candidates.Num() - 1;
+		float CurrentWeight = 0.0f;
+		for (int32 Index = 0; Index < Candidates.Num(); ++Index)
+		{
+			CurrentWeight += InteriorPool[Candidates[Index]].PlacementWeight;
+			if (RandomWeight <= CurrentWeight)
+			{
+				CandidateIndex = Index;
+				break;
+			}
+		}
+
+		const FMeshPlacementInfo& Info = InteriorPool[Candidates[CandidateIndex]];
+
+		// B. Try the allowed rotations starting from a random one
+		const int32 NumRotations = Info.AllowedRotations.Num();
+		const int32 FirstRotation = Stream.RandRange(0, NumRotations - 1);
+
+		bool bFound = false;
+		float YawRotation = 0.0f;
+		FIntPoint RotatedFootprint = Info.GridFootprint;
+		FIntRect FreeRect;
+
+		for (int32 Step = 0; Step < NumRotations && !bFound; ++Step)
+		{
+			YawRotation = (float)Info.AllowedRotations[(FirstRotation + Step) % NumRotations];
+			RotatedFootprint = GetRotatedFootprint(Info, YawRotation);
+			bFound = Packer.FindBestFit(RotatedFootprint, FreeRect);
+		}
+
+		if (!bFound)
+		{
+			Candidates.RemoveAtSwap(CandidateIndex);
+			continue;
+		}
+
+		// C. Random offset inside the chosen free rectangle keeps layouts from hugging one corner
+		const FIntPoint Start(
+			FreeRect.Min.X + Stream.RandRange(0, FreeRect.Width() - RotatedFootprint.X),
+			FreeRect.Min.Y + Stream.RandRange(0, FreeRect.Height() - RotatedFootprint.Y)
+		);
+		const FIntRect UsedRect(Start, Start + RotatedFootprint);
+		Packer.Occupy(UsedRect);
+
+		// D. Placement and Occupancy Marking
+		AddPlacement(Info.MeshAsset, Start, RotatedFootprint, YawRotation, ERoomLayer::Interior);
+
+		for (int32 FootY = UsedRect.Min.Y; FootY < UsedRect.Max.Y; ++FootY)
+		{
+			for (int32 FootX = UsedRect.Min.X; FootX < UsedRect.Max.X; ++FootX)
+			{
+				InteriorOccupancy[FootY * GridSize.X + FootX] = true;
+			}
+		}
+		CoveredCells += RotatedFootprint.X * RotatedFootprint.Y;
+	}
+}
+
+void FRoomLayoutSolver::GenerateWallsAndDoors()
+{
+	const UWallData* WallData = Input->WallData;
+	if (!WallData) return;
+
+	// --- Corner Placement ---
+	if (!WallData->DefaultCornerMesh.IsNull() && !Input->bGridOnly)
+	{
+		// Note: Placed at grid vertices (0,0), (LengthX, 0), etc. using BackBottomCenter pivot assumption.
+		const int32 CornerMeshIndex = Layout->AddMesh(WallData->DefaultCornerMesh);
+		const float LengthX = GridSize.X * CELL_SIZE;
+		const float LengthY = GridSize.Y * CELL_SIZE;
+
+		auto AddCorner = [this, CornerMeshIndex](float Yaw, const FVector& Location)
+		{
+			FRoomMeshPlacement& Placement = Layout->Placements.AddDefaulted_GetRef();
+			Placement.MeshIndex = CornerMeshIndex;
+			Placement.Transform = FTransform(FRotator(0.0f, Yaw, 0.0f), Location);
+			Placement.Layer = ERoomLayer::Wall;
+		};
+
+		// A. Corner (0, 0)
+		AddCorner(0.0f, FVector::ZeroVector);
+
+		// B. Corner (LengthX, 0)
+		AddCorner(90.0f, FVector(LengthX, 0.0f, 0.0f));
+
+		// C. Corner (0, LengthY)
+		AddCorner(-90.0f, FVector(0.0f, LengthY, 0.0f));
+
+		// D. Corner (LengthX, LengthY)
+		AddCorner(180.0f, FVector(LengthX, LengthY, 0.0f));
+	}
+
+	// --- Next Implementation: Door Reservation and 1D Wall Packing ---
+}
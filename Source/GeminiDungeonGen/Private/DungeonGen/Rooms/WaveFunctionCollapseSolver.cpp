@@ -0,0 +1,224 @@
+// WaveFunctionCollapseSolver.cpp
+
+#include "DungeonGen/Rooms/WaveFunctionCollapseSolver.h"
+
+bool FWaveFunctionCollapseSolver::Solve(const FIntPoint& InSize, TConstArrayView<float> Weights, TConstArrayView<uint64> Compatible,
+	TArray<uint64>& InOutDomains, FRandomStream& Stream, int32 MaxBacktracks, const std::atomic<bool>* CancelFlag)
+{
+	const int32 NumTiles = Weights.Num();
+	const int32 NumCells = InSize.X * InSize.Y;
+	if (NumTiles == 0 || NumTiles > MaxTiles || Compatible.Num() != NumTiles || InOutDomains.Num() != NumCells)
+	{
+		return false;
+	}
+
+	Size = InSize;
+	Domains = InOutDomains.GetData();
+	CompatibleMasks = Compatible.GetData();
+	RandomStream = &Stream;
+	NumBacktracks = 0;
+
+	for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+	{
+		TileWeights[Tile] = FMath::Max(Weights[Tile], UE_SMALL_NUMBER);
+		TileWeightLogWeights[Tile] = TileWeights[Tile] * FMath::Loge(TileWeights[Tile]);
+	}
+
+	Versions.Reset();
+	Versions.AddZeroed(NumCells);
+	Trail.Reset();
+	Decisions.Reset();
+	Heap.Reset();
+	PropagationStack.Reset();
+
+	// 1. Initial propagation: every active cell constrains its neighbours once
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		if (Domains[Cell] != 0)
+		{
+			PropagationStack.Add(Cell);
+		}
+	}
+	if (!Propagate())
+	{
+		return false;
+	}
+
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		if (FMath::CountBits(Domains[Cell]) > 1)
+		{
+			PushEntropy(Cell);
+		}
+	}
+
+	// 2. Collapse the lowest-entropy cell, propagate, and backtrack on contradictions
+	for (int32 Step = 0; ; ++Step)
+	{
+		if (CancelFlag && (Step & 255) == 0 && CancelFlag->load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		const int32 Cell = PopLowestEntropy();
+		if (Cell == INDEX_NONE)
+		{
+			return true;
+		}
+
+		const int32 Tile = PickWeightedTile(Domains[Cell]);
+		Decisions.Add({ Trail.Num(), Cell, Tile });
+		SetDomain(Cell, (uint64)1 << Tile);
+
+		bool bConsistent = Propagate();
+		while (!bConsistent)
+		{
+			if (Decisions.Num() == 0 || NumBacktracks >= MaxBacktracks)
+			{
+				return false;
+			}
+			++NumBacktracks;
+
+			// Undo the last decision and ban its tile; the ban belongs to the previous decision level
+			const FDecision Failed = Decisions.Pop(EAllowShrinking::No);
+			UndoTo(Failed.TrailMark);
+
+			const uint64 Remaining = Domains[Failed.Cell] & ~((uint64)1 << Failed.Tile);
+			if (Remaining == 0)
+			{
+				// Every candidate of this cell failed: the contradiction is further up
+				continue;
+			}
+
+			SetDomain(Failed.Cell, Remaining);
+			bConsistent = Propagate();
+		}
+	}
+}
+
+void FWaveFunctionCollapseSolver::SetDomain(int32 Cell, uint64 NewDomain)
+{
+	Trail.Add({ Cell, Domains[Cell] });
+	Domains[Cell] = NewDomain;
+	++Versions[Cell];
+	PropagationStack.Add(Cell);
+
+	if (FMath::CountBits(NewDomain) > 1)
+	{
+		PushEntropy(Cell);
+	}
+}
+
+void FWaveFunctionCollapseSolver::UndoTo(int32 TrailMark)
+{
+	PropagationStack.Reset();
+
+	while (Trail.Num() > TrailMark)
+	{
+		const FTrailEntry Entry = Trail.Pop(EAllowShrinking::No);
+		Domains[Entry.Cell] = Entry.OldDomain;
+		++Versions[Entry.Cell];
+
+		// Older heap entries for the cell are stale now; queue it again with its restored domain
+		if (FMath::CountBits(Entry.OldDomain) > 1)
+		{
+			PushEntropy(Entry.Cell);
+		}
+	}
+}
+
+bool FWaveFunctionCollapseSolver::Propagate()
+{
+	while (PropagationStack.Num() > 0)
+	{
+		const int32 Cell = PropagationStack.Pop(EAllowShrinking::No);
+		const int32 X = Cell % Size.X;
+		const int32 Y = Cell / Size.X;
+
+		// Union of what the remaining candidates allow next to them
+		uint64 Allowed = 0;
+		for (uint64 Remaining = Domains[Cell]; Remaining != 0; Remaining &= Remaining - 1)
+		{
+			Allowed |= CompatibleMasks[FMath::CountTrailingZeros64(Remaining)];
+		}
+
+		const int32 Neighbours[4] = {
+			X > 0 ? Cell - 1 : INDEX_NONE,
+			X < Size.X - 1 ? Cell + 1 : INDEX_NONE,
+			Y > 0 ? Cell - Size.X : INDEX_NONE,
+			Y < Size.Y - 1 ? Cell + Size.X : INDEX_NONE
+		};
+
+		for (const int32 Neighbour : Neighbours)
+		{
+			// Inactive cells (domain 0) neither constrain nor get constrained
+			if (Neighbour == INDEX_NONE || Domains[Neighbour] == 0) continue;
+
+			const uint64 Narrowed = Domains[Neighbour] & Allowed;
+			if (Narrowed == Domains[Neighbour]) continue;
+
+			if (Narrowed == 0)
+			{
+				PropagationStack.Reset();
+				return false;
+			}
+			SetDomain(Neighbour, Narrowed);
+		}
+	}
+	return true;
+}
+
+void FWaveFunctionCollapseSolver::PushEntropy(int32 Cell)
+{
+	float SumWeights = 0.0f;
+	float SumWeightLogWeights = 0.0f;
+	for (uint64 Remaining = Domains[Cell]; Remaining != 0; Remaining &= Remaining - 1)
+	{
+		const int32 Tile = FMath::CountTrailingZeros64(Remaining);
+		SumWeights += TileWeights[Tile];
+		SumWeightLogWeights += TileWeightLogWeights[Tile];
+	}
+
+	// Shannon entropy of the weighted candidates, plus a little noise to break ties randomly
+	const float Entropy = FMath::Loge(SumWeights) - SumWeightLogWeights / SumWeights + RandomStream->FRand() * 1.0e-4f;
+	Heap.HeapPush({ Entropy, Cell, Versions[Cell] });
+}
+
+int32 FWaveFunctionCollapseSolver::PopLowestEntropy()
+{
+	while (Heap.Num() > 0)
+	{
+		FHeapEntry Entry;
+		Heap.HeapPop(Entry, EAllowShrinking::No);
+
+		// Entries are invalidated lazily: skip any pushed before the cell's latest change
+		if (Entry.Version == Versions[Entry.Cell] && FMath::CountBits(Domains[Entry.Cell]) > 1)
+		{
+			return Entry.Cell;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 FWaveFunctionCollapseSolver::PickWeightedTile(uint64 Domain)
+{
+	float TotalWeight = 0.0f;
+	for (uint64 Remaining = Domain; Remaining != 0; Remaining &= Remaining - 1)
+	{
+		TotalWeight += TileWeights[FMath::CountTrailingZeros64(Remaining)];
+	}
+
+	const float RandomWeight = RandomStream->FRand() * TotalWeight;
+	float CurrentWeight = 0.0f;
+	int32 Tile = INDEX_NONE;
+	for (uint64 Remaining = Domain; Remaining != 0; Remaining &= Remaining - 1)
+	{
+		Tile = FMath::CountTrailingZeros64(Remaining);
+		CurrentWeight += TileWeights[Tile];
+		if (RandomWeight <= CurrentWeight)
+		{
+			break;
+		}
+	}
+	return Tile;
+}
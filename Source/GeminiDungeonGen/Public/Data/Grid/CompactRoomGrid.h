@@ -0,0 +1,90 @@
+﻿// CompactRoomGrid.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/Grid/GridData.h"
+
+// --- Compact Room Grid ---
+
+// Row-major room grid that stores one EGridCellType per cell in 2 bits (32 cells per uint64),
+// so the final layout can stay resident for gameplay queries at a quarter of a byte-per-cell array.
+struct FCompactRoomGrid
+{
+public:
+	static constexpr int32 BitsPerCell = 2;
+	static constexpr int32 CellsPerWord = 64 / BitsPerCell;
+
+	// Resizes the grid and fills every cell with FillType. Keeps the allocation when the size is unchanged.
+	void Init(const FIntPoint& InSize, EGridCellType FillType)
+	{
+		Size = FIntPoint(FMath::Max(0, InSize.X), FMath::Max(0, InSize.Y));
+		const int32 NumWords = (Num() + CellsPerWord - 1) / CellsPerWord;
+
+		// Replicate the 2-bit pattern across the whole word
+		uint64 FillWord = 0;
+		for (int32 Slot = 0; Slot < CellsPerWord; ++Slot)
+		{
+			FillWord |= (uint64)FillType << (Slot * BitsPerCell);
+		}
+
+		// Never shrinks, so regenerating at the same (or a smaller) size reuses the buffer
+		Words.SetNumUninitialized(NumWords, EAllowShrinking::No);
+		for (uint64& Word : Words)
+		{
+			Word = FillWord;
+		}
+	}
+
+	void Empty()
+	{
+		Size = FIntPoint::ZeroValue;
+		Words.Empty();
+	}
+
+	FORCEINLINE int32 Num() const { return Size.X * Size.Y; }
+	FORCEINLINE const FIntPoint& GetSize() const { return Size; }
+	FORCEINLINE bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < Num(); }
+	FORCEINLINE bool IsValidCell(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Size.X && Y < Size.Y; }
+	FORCEINLINE int32 ToIndex(int32 X, int32 Y) const { return Y * Size.X + X; }
+
+	FORCEINLINE EGridCellType Get(int32 Index) const
+	{
+		checkSlow(IsValidIndex(Index));
+		const int32 Shift = (Index % CellsPerWord) * BitsPerCell;
+		return (EGridCellType)((Words[Index / CellsPerWord] >> Shift) & 0x3);
+	}
+
+	FORCEINLINE void Set(int32 Index, EGridCellType Type)
+	{
+		checkSlow(IsValidIndex(Index));
+		const int32 Shift = (Index % CellsPerWord) * BitsPerCell;
+		uint64& Word = Words[Index / CellsPerWord];
+		Word = (Word & ~((uint64)0x3 << Shift)) | ((uint64)Type << Shift);
+	}
+
+	// Packed words, CellsPerWord cells each (the last one may be partly padding)
+	FORCEINLINE int32 NumWords() const { return Words.Num(); }
+
+	// One bit per cell of packed word WordIndex (cells WordIndex * CellsPerWord onwards), set where the
+	// cell is Type. Compares all 32 fields at once, then compacts the even bits into the low 32 bits.
+	FORCEINLINE uint32 GetTypeBits(int32 WordIndex, EGridCellType Type) const
+	{
+		const uint64 Diff = Words[WordIndex] ^ (0x5555555555555555ull * (uint64)Type);
+		uint64 Match = ~(Diff | (Diff >> 1)) & 0x5555555555555555ull;
+		Match = (Match | (Match >> 1)) & 0x3333333333333333ull;
+		Match = (Match | (Match >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+		Match = (Match | (Match >> 4)) & 0x00FF00FF00FF00FFull;
+		Match = (Match | (Match >> 8)) & 0x0000FFFF0000FFFFull;
+		Match = (Match | (Match >> 16)) & 0x00000000FFFFFFFFull;
+		return (uint32)Match;
+	}
+
+	SIZE_T GetAllocatedSize() const { return Words.GetAllocatedSize(); }
+
+private:
+	FIntPoint Size = FIntPoint::ZeroValue;
+	TArray<uint64> Words;
+};
+
+static_assert((uint8)EGridCellType::ECT_Doorway < 4, "FCompactRoomGrid packs EGridCellType into 2 bits");
@@ -0,0 +1,57 @@
+﻿// GridBitMask.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// --- Grid Bit Mask ---
+
+// One bit per 100cm cell, stored row by row in uint64 words (bit X%64 of word X/64 in each row).
+// Used for word-parallel flood fills over walkable cells. Padding bits past Size.X are always 0.
+struct GEMINIDUNGEONGEN_API FGridBitMask
+{
+public:
+	void Init(const FIntPoint& InSize, bool bValue);
+
+	FORCEINLINE const FIntPoint& GetSize() const { return Size; }
+	FORCEINLINE bool IsValidCell(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Size.X && Y < Size.Y; }
+
+	FORCEINLINE bool Get(int32 X, int32 Y) const
+	{
+		return (Words[Y * WordsPerRow + (X >> 6)] >> (X & 63)) & 1;
+	}
+
+	FORCEINLINE void Set(int32 X, int32 Y, bool bValue)
+	{
+		uint64& Word = Words[Y * WordsPerRow + (X >> 6)];
+		const uint64 Bit = (uint64)1 << (X & 63);
+		Word = bValue ? (Word | Bit) : (Word & ~Bit);
+	}
+
+	// Direct access to one row's words, for builders that produce 64 cells at a time
+	FORCEINLINE uint64* GetRowData(int32 Y) { return Words.GetData() + Y * WordsPerRow; }
+
+	int32 CountSetBits() const;
+
+	// Row-major first set cell; false if the mask is empty
+	bool FindFirstSetBit(FIntPoint& OutCell) const;
+
+	// this &= ~Other
+	void AndNot(const FGridBitMask& Other);
+
+	// Fills OutReached with every cell 4-connected to Seed through Walkable.
+	// Rows are expanded with a Kogge-Stone occluded fill (64 cells per op) and sweeps alternate
+	// down/up until nothing changes.
+	static void FloodFill(const FGridBitMask& Walkable, const FIntPoint& Seed, FGridBitMask& OutReached);
+
+	// Splits Walkable into 4-connected regions and calls Visitor once per region
+	static void ForEachRegion(const FGridBitMask& Walkable, TFunctionRef<void(const FGridBitMask& Region, int32 NumCells, const FIntPoint& FirstCell)> Visitor);
+
+private:
+	// Fills one row of Reached horizontally within Walkable; returns true if the row changed
+	static bool FillRow(uint64* ReachedRow, const uint64* WalkableRow, int32 NumWords);
+
+	FIntPoint Size = FIntPoint::ZeroValue;
+	int32 WordsPerRow = 0;
+	TArray<uint64> Words;
+};
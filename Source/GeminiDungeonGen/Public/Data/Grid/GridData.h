@@ -49,6 +49,17 @@ struct FMeshPlacementInfo
 	// If the mesh is non-square, define allowed rotations (e.g., 0 and 90)
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mesh Info")
 	TArray<int32> AllowedRotations = {0}; 
+
+	// --- Adjacency (Wave Function Collapse floor solver, 1x1 tiles only) ---
+
+	// Identifies this tile in other tiles' AllowedNeighbourTags (e.g., "Stone", "StoneTrim")
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Adjacency")
+	FName TileTag;
+
+	// Tags that may border this tile on any side. Empty allows every neighbour.
+	// Rules are symmetric: two tiles may touch only if each one allows the other.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Adjacency")
+	TArray<FName> AllowedNeighbourTags;
 };
 
 // --- Wall Module Info ---
@@ -0,0 +1,35 @@
+﻿// MaxRectsPacker.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// --- MaxRects Free-Rectangle Packer ---
+
+// Tracks the maximal free rectangles of a room grid (in 100cm cells) so large multi-cell
+// footprints can be placed directly into space that is known to fit them, instead of
+// scanning cell-by-cell and rejecting overlaps.
+// Rectangles use FIntRect semantics: Min is inclusive, Max is exclusive.
+struct GEMINIDUNGEONGEN_API FMaxRectsPacker
+{
+public:
+	// Resets the packer to a single free rectangle covering the whole grid, then carves out
+	// every cell flagged in BlockedCells (row-major, GridSize.X * GridSize.Y entries).
+	void Init(const FIntPoint& InGridSize, const TBitArray<>& BlockedCells);
+
+	// Finds the free rectangle that fits Size with the smallest leftover on its short side
+	// (Best Short Side Fit). Returns false if no free rectangle can hold the footprint.
+	bool FindBestFit(const FIntPoint& Size, FIntRect& OutFreeRect) const;
+
+	// Removes UsedRect from the free space, splitting every free rectangle it overlaps.
+	void Occupy(const FIntRect& UsedRect);
+
+	const TArray<FIntRect>& GetFreeRects() const { return FreeRects; }
+
+private:
+	// Removes free rectangles that are fully contained by another free rectangle.
+	void PruneFreeRects();
+
+	FIntPoint GridSize = FIntPoint::ZeroValue;
+	TArray<FIntRect> FreeRects;
+};
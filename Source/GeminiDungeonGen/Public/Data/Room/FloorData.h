@@ -8,6 +8,17 @@
 
 struct FMeshPlacementInfo;
 
+// How the base floor tiles are chosen
+UENUM(BlueprintType)
+enum class EFloorSolverMode : uint8
+{
+	// Independent weighted pick per cell (supports large footprints)
+	WeightedRandom			UMETA(DisplayName = "Weighted Random"),
+
+	// Wave function collapse over the 1x1 tiles, honouring TileTag / AllowedNeighbourTags
+	WaveFunctionCollapse	UMETA(DisplayName = "Wave Function Collapse")
+};
+
 UCLASS()
 class GEMINIDUNGEONGEN_API UFloorData : public UDataAsset
 {
@@ -39,4 +50,13 @@ public:
 	// A specific 1x1 mesh used to fill any remaining empty cells after the main randomized pass.
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Floor Tiles")
 	TSoftObjectPtr<UStaticMesh> DefaultFillerTile;
+
+	// --- Floor Solver ---
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Floor Solver")
+	EFloorSolverMode SolverMode = EFloorSolverMode::WeightedRandom;
+
+	// Failed choices WFC may undo before it gives up and the weighted pass is used instead
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Floor Solver", meta=(ClampMin="0", EditCondition="SolverMode == EFloorSolverMode::WaveFunctionCollapse"))
+	int32 WFCMaxBacktracks = 2000;
 };
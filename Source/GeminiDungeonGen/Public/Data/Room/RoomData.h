@@ -38,4 +38,8 @@ public:
 	// Meshes used to fill the interior of the room grid (clutter, furniture, etc.)
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interior Meshes")
 	TArray<FMeshPlacementInfo> InteriorMeshPool;
+
+	// Fraction (0.0 to 1.0) of the free interior cells the furniture pass tries to cover.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interior Meshes", meta=(ClampMin="0.0", ClampMax="1.0", UIMin="0.0", UIMax="1.0"))
+	float InteriorFillRatio = 0.3f;
 };
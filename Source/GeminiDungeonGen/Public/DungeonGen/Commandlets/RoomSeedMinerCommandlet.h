@@ -0,0 +1,28 @@
+﻿// RoomSeedMinerCommandlet.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RoomSeedMinerCommandlet.generated.h"
+
+// --- Room Seed Miner ---
+
+// Headless seed search for a room data asset. Runs FRoomLayoutSolver on every core (no actors or
+// components), scores each layout and writes the best seeds with their stats to CSV.
+//
+// Usage:
+//   UnrealEditor-Cmd GeminiDungeonGen.uproject -run=RoomSeedMiner -Room=/Game/Data/DA_RoomData.DA_RoomData
+//     [-Seeds=1000000] [-StartSeed=0] [-Top=100] [-Out=<csv path>]
+//     [-MaxFillerRatio=1.0] [-AllowDisconnected]
+//     [-ConnectivityWeight=1.0] [-FurnitureWeight=1.0] [-FillerWeight=1.0] [-VarietyWeight=0.5]
+UCLASS()
+class GEMINIDUNGEONGEN_API URoomSeedMinerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URoomSeedMinerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
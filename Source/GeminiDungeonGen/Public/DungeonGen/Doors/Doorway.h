@@ -6,6 +6,10 @@
 #include "GameFramework/Actor.h"
 #include "Doorway.generated.h"
 
+class ADungeonManager;
+
+// A doorway between two rooms. Open/lock state is owned and replicated by ADungeonManager's
+// door state array, so the actor itself stays net-dormant and only ticks while it animates.
 UCLASS()
 class GEMINIDUNGEONGEN_API ADoorway : public AActor
 {
@@ -15,11 +19,67 @@ public:
 	// Sets default values for this actor's properties
 	ADoorway();
 
+	// --- Components ---
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Door")
+	TObjectPtr<USceneComponent> DoorRoot;
+
+	// Rotated when the door opens; attach the door leaf mesh to it in the Blueprint
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Door")
+	TObjectPtr<USceneComponent> DoorPivot;
+
+	// --- Animation ---
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door|Animation")
+	float OpenYaw = 90.0f;
+
+	// Seconds for a full open or close (0 snaps)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door|Animation", meta=(ClampMin="0.0"))
+	float OpenDuration = 0.5f;
+
+	// --- State ---
+
+	// Server: routes through the owning manager so the change replicates with the other doors
+	UFUNCTION(BlueprintCallable, Category = "Door")
+	void SetDoorOpen(bool bOpen);
+
+	UFUNCTION(BlueprintCallable, Category = "Door")
+	void SetDoorLocked(bool bLocked);
+
+	UFUNCTION(BlueprintPure, Category = "Door")
+	bool IsOpen() const { return bIsOpen; }
+
+	UFUNCTION(BlueprintPure, Category = "Door")
+	bool IsLocked() const { return bIsLocked; }
+
+	// Applies replicated state on server and clients. bSnap skips the animation (late joiners).
+	void ApplyDoorState(bool bOpen, bool bLocked, bool bSnap);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Door")
+	void OnDoorStateChanged(bool bOpen, bool bLocked);
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
 public:
-	// Called every frame
+	// Only enabled while the pivot is between closed and open
 	virtual void Tick(float DeltaTime) override;
+
+private:
+	friend class ADungeonManager;
+
+	void UpdatePivot();
+
+	// Set by ADungeonManager::RegisterDoor (server only)
+	UPROPERTY(Transient)
+	TObjectPtr<ADungeonManager> OwningManager = nullptr;
+
+	int32 DoorStateIndex = INDEX_NONE;
+
+	bool bIsOpen = false;
+	bool bIsLocked = false;
+
+	// 0 = closed, 1 = open
+	float OpenAlpha = 0.0f;
 };
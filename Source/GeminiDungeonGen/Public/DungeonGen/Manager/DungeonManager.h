@@ -4,8 +4,129 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "UObject/ObjectKey.h"
 #include "DungeonManager.generated.h"
 
+class AMasterRoom;
+class ADoorway;
+class URoomData;
+class UStaticMesh;
+class UHierarchicalInstancedStaticMeshComponent;
+class UBoxComponent;
+
+// --- Dungeon Structs ---
+
+// A doorway connecting two rooms. Cells are in each room's local 100cm grid.
+USTRUCT(BlueprintType)
+struct FDungeonDoorLink
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door Link")
+	TObjectPtr<AMasterRoom> RoomA = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door Link")
+	FIntPoint CellA = FIntPoint::ZeroValue;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door Link")
+	TObjectPtr<AMasterRoom> RoomB = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door Link")
+	FIntPoint CellB = FIntPoint::ZeroValue;
+
+	// Optional door actor in this link; registered with the manager's door state array on BeginPlay
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door Link")
+	TObjectPtr<ADoorway> Door = nullptr;
+};
+
+// Replicated open/lock state of one doorway
+USTRUCT()
+struct FDoorStateItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<ADoorway> Door = nullptr;
+
+	UPROPERTY()
+	bool bOpen = false;
+
+	UPROPERTY()
+	bool bLocked = false;
+
+	// Client callbacks: push the state into the (dormant) door actor
+	void PostReplicatedAdd(const struct FDoorStateArray& InArraySerializer);
+	void PostReplicatedChange(const struct FDoorStateArray& InArraySerializer);
+};
+
+// Every door of the dungeon in one delta-serialized array, so only changed doors are sent
+USTRUCT()
+struct FDoorStateArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FDoorStateItem> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FDoorStateItem, FDoorStateArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FDoorStateArray> : public TStructOpsTypeTraitsBase2<FDoorStateArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+// Connectivity problems found in a single room
+USTRUCT(BlueprintType)
+struct FRoomConnectivityIssue
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	TObjectPtr<AMasterRoom> Room = nullptr;
+
+	// Walkable cells of this room that cannot be reached from the start room
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	int32 UnreachableCells = 0;
+
+	// One cell of the first unreachable region (room-local), for debugging
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	FIntPoint SampleCell = FIntPoint::ZeroValue;
+
+	// Separate walkable regions inside the room (1 means the room itself is connected)
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	int32 NumRegions = 0;
+
+	// Door cells of this room that ended up covered or outside the floor
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	int32 BlockedDoorCells = 0;
+
+	// True when the defect is inside the room's own layout, so rerolling the room can fix it
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	bool bNeedsRepair = false;
+};
+
+USTRUCT(BlueprintType)
+struct FDungeonConnectivityReport
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	bool bIsTraversable = true;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Connectivity")
+	TArray<FRoomConnectivityIssue> Issues;
+};
+
 UCLASS()
 class GEMINIDUNGEONGEN_API ADungeonManager : public AActor
 {
@@ -15,12 +136,245 @@ public:
 	// Sets default values for this actor's properties
 	ADungeonManager();
 
+	// --- Dungeon Layout ---
+
+	// Rooms that make up the dungeon. Rooms[0] is the start room for connectivity checks.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon")
+	TArray<TObjectPtr<AMasterRoom>> Rooms;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon")
+	TArray<FDungeonDoorLink> DoorLinks;
+
+	// --- Connectivity Validation ---
+
+	// Validate (and repair) traversability every time GenerateDungeon runs
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Validation")
+	bool bValidateConnectivity = true;
+
+	// How many times a broken room may be rerolled before giving up
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Validation", meta=(ClampMin="0"))
+	int32 MaxRepairRerolls = 8;
+
+	// Unreachable regions smaller than this (e.g. one cell boxed in by furniture) are ignored
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Validation", meta=(ClampMin="1"))
+	int32 MinReportedRegionCells = 1;
+
+	// Server: regenerates every room, then validates and repairs connectivity
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Dungeon")
+	void GenerateDungeon();
+
+	// Flood fills each room's walkable cells and walks the door graph from the start room
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Validation")
+	FDungeonConnectivityReport ValidateConnectivity() const;
+
+	// Rerolls only the rooms whose own layout breaks connectivity. Returns true once traversable.
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Validation")
+	bool ValidateAndRepair();
+
+	// --- Shared Instancing ---
+
+	// Rooms add their instances to manager-owned HISMs (one per mesh and spatial cell) instead of their own
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Rendering")
+	bool bShareInstancedMeshes = false;
+
+	// Edge length of a shared HISM's spatial cell in 100cm cells (culling granularity)
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Rendering", meta=(ClampMin="1"))
+	int32 SharedMeshCellSize = 64;
+
+	// Appends a room's world-space instances to the shared HISMs and records its instance ranges.
+	// Collision-free instances go to separate HISMs so they never create physics bodies.
+	void AddSharedInstances(AMasterRoom* Room, UStaticMesh* Mesh, TConstArrayView<FTransform> WorldTransforms, bool bCollision = true);
+
+	// Removes every instance range the room owns. Each hole is filled from the end of the HISM (swap
+	// removal), so the cost scales with the room's instance count, not with what lies behind it.
+	void RemoveSharedInstances(AMasterRoom* Room);
+
+	// --- Relevance ---
+
+	// Keep every room as a solved layout and only spawn instances and collision for rooms near a player.
+	// Game worlds only (the editor always materializes); dedicated servers keep their box collision.
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Relevance")
+	bool bLazyMaterialization = false;
+
+	// Rooms whose grid comes within this distance (cm) of any player are materialized
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Relevance", meta=(ClampMin="0.0", EditCondition="bLazyMaterialization"))
+	float MaterializeRadius = 6000.0f;
+
+	// Extra distance (cm) before a materialized room is released again, so rooms on the edge don't flicker
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Relevance", meta=(ClampMin="0.0", EditCondition="bLazyMaterialization"))
+	float DematerializeHysteresis = 1500.0f;
+
+	// Seconds between relevance checks
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Relevance", meta=(ClampMin="0.05", EditCondition="bLazyMaterialization"))
+	float RelevanceCheckInterval = 0.25f;
+
+	// Rooms materialized per check, nearest first, to spread the spawn cost over frames (0 = no limit)
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Relevance", meta=(ClampMin="0", EditCondition="bLazyMaterialization"))
+	int32 MaxMaterializationsPerCheck = 2;
+
+	// Materializes rooms in range of a player and dematerializes those beyond radius + hysteresis
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Relevance")
+	void UpdateRoomRelevance();
+
+	UFUNCTION(BlueprintPure, Category = "Dungeon|Relevance")
+	int32 GetNumMaterializedRooms() const;
+
+	// Component pools for lazily materialized rooms. Pooled components are owned by the manager and
+	// come back unregistered and detached; the room sets them up and attaches them to itself.
+	UHierarchicalInstancedStaticMeshComponent* AcquirePooledHISM();
+	void ReleasePooledHISM(UHierarchicalInstancedStaticMeshComponent* HISM);
+	UBoxComponent* AcquirePooledBox();
+	void ReleasePooledBox(UBoxComponent* BoxComponent);
+
+	// --- Doors ---
+
+	// Server: adds a door to the replicated door state array and returns its index
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Doors")
+	int32 RegisterDoor(ADoorway* Door, bool bStartOpen = false, bool bStartLocked = false);
+
+	// Server: no-op when unchanged, so untouched doors cost nothing to replicate
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Doors")
+	void SetDoorOpen(int32 DoorIndex, bool bOpen);
+
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Doors")
+	void SetDoorLocked(int32 DoorIndex, bool bLocked);
+
+	UFUNCTION(BlueprintPure, Category = "Dungeon|Doors")
+	bool IsDoorOpen(int32 DoorIndex) const;
+
+	UFUNCTION(BlueprintPure, Category = "Dungeon|Doors")
+	bool IsDoorLocked(int32 DoorIndex) const;
+
+	// --- Floors ---
+
+	// Room styles a floor draws from. Empty keeps each room's own RoomDataAsset.
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Floors")
+	TArray<TSoftObjectPtr<URoomData>> RoomDataPool;
+
+	// Drives every floor's room list and room seeds. Clients start prefetching once it has arrived.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_DungeonSeed, Category = "Dungeon|Floors")
+	int32 DungeonSeed = 1337;
+
+	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_CurrentFloorIndex, Category = "Dungeon|Floors")
+	int32 CurrentFloorIndex = 0;
+
+	// Deterministic room data for each entry of Rooms on the given floor (no loading)
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Floors")
+	void ResolveFloorRooms(int32 FloorIndex, TArray<TSoftObjectPtr<URoomData>>& OutRoomData) const;
+
+	int32 GetFloorRoomSeed(int32 FloorIndex, int32 RoomIndex) const;
+
+	// Server: waits for the next floor's structural meshes (async), then hands the prefetched assets over and regenerates
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Floors")
+	void AdvanceToNextFloor();
+
+	// --- Predictive Streaming ---
+
+	// Stream the next floor's meshes in while players are on the current one
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Streaming")
+	bool bPrefetchNextFloor = true;
+
+	// Estimated mesh memory the prefetch may hold; detail meshes are skipped once it is exceeded
+	UPROPERTY(EditAnywhere, Category = "Dungeon|Streaming", meta=(ClampMin="0"))
+	int32 PrefetchBudgetMB = 256;
+
+	// Low-priority async load of every mesh referenced by a floor's room, floor, wall and door data
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Streaming")
+	void PrefetchFloor(int32 FloorIndex);
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION()
+	void OnRep_DungeonSeed();
+
+	UFUNCTION()
+	void OnRep_CurrentFloorIndex();
+
+	UPROPERTY(Replicated)
+	FDoorStateArray DoorStates;
+
+private:
+	// One room's contiguous block of instances inside a shared HISM
+	struct FSharedInstanceRange
+	{
+		TObjectKey<AMasterRoom> Room;
+		int32 Start = 0;
+		int32 Count = 0;
+	};
+
+	// The ranges of one shared HISM, sorted by Start. A room may own several ranges in one HISM
+	// (swap removal splits a range when only its back part is moved).
+	struct FSharedHISMEntry
+	{
+		TArray<FSharedInstanceRange> Ranges;
+	};
+
+	int32 GetOrCreateSharedHISM(UStaticMesh* Mesh, const FIntPoint& SpatialCell, bool bCollision);
+	void RemoveInstanceRange(int32 EntryIndex, int32 RangeIndex);
+
+	// Parallel arrays: the components are GC-tracked (nulled if destroyed), the entries hold their ranges
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>> SharedHISMComponents;
+	TArray<FSharedHISMEntry> SharedHISMs;
+
+	// (mesh, spatial cell, collision) -> entry; the component keeps its mesh alive, the key does not
+	TMap<TTuple<TObjectKey<UStaticMesh>, FIntPoint, bool>, int32> SharedHISMLookup;
+
+	// Shared HISM entries each room has instances in
+	TMap<TObjectKey<AMasterRoom>, TArray<int32>> RoomSharedHISMs;
+
+	// True when rooms wait for UpdateRoomRelevance instead of materializing on generation
+	bool UsesLazyMaterialization() const;
+
+	// Lazy materialization and shared instancing setup, identical on server and clients
+	void ConfigureRoom(AMasterRoom* Room);
+
+	FTimerHandle RelevanceTimerHandle;
+
+	// Released components of dematerialized rooms (unregistered, no instances, no mesh)
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>> HISMPool;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UBoxComponent>> BoxPool;
+
+	// Prefetch stages: room data -> style data -> structural meshes -> detail meshes (in small batches)
+	void OnPrefetchRoomDataLoaded(int32 FloorIndex);
+	void OnPrefetchStyleDataLoaded(int32 FloorIndex);
+	void OnPrefetchStructuralLoaded(int32 FloorIndex);
+	void RequestNextDetailBatch(int32 FloorIndex);
+
+	// Floor switches wait (asynchronously) for the target floor's structural stage before handing over
+	void BeginFloorAdvance(int32 FloorIndex);
+	void FinishFloorAdvance();
+
+	// Promotes the next floor's prefetch handles to current and releases the previous floor's
+	void HandOverPrefetchedFloor();
+
+	// Sum of the estimated resource size of the loaded meshes in Paths
+	int64 GetLoadedMeshBytes(TConstArrayView<FSoftObjectPath> Paths) const;
+
+	void ReleaseHandles(TArray<TSharedPtr<FStreamableHandle>>& Handles);
+
+	// Floor the prefetch handles belong to (INDEX_NONE when idle)
+	int32 PrefetchedFloorIndex = INDEX_NONE;
+
+	// Room, style and structural mesh stages of PrefetchedFloorIndex are resident
+	bool bPrefetchStructuralLoaded = false;
+
+	// Floor a switch is waiting on (INDEX_NONE when none)
+	int32 PendingFloorIndex = INDEX_NONE;
+
+	TArray<TSoftObjectPtr<URoomData>> PrefetchRoomData;
+	TArray<FSoftObjectPath> PrefetchStructuralMeshes;
+	TArray<FSoftObjectPath> PrefetchDetailMeshes;
+	int32 PrefetchDetailCursor = 0;
 
+	// Keep the current floor's and the next floor's assets resident; older floors are released
+	TArray<TSharedPtr<FStreamableHandle>> CurrentFloorHandles;
+	TArray<TSharedPtr<FStreamableHandle>> NextFloorHandles;
 };
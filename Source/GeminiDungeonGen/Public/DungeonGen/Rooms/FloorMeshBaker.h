@@ -0,0 +1,29 @@
+﻿// FloorMeshBaker.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UStaticMesh;
+
+// One floor instance to be merged (transform is in the owning room's local space)
+struct FFloorBakeInstance
+{
+	UStaticMesh* Mesh = nullptr;
+	FTransform Transform;
+};
+
+// --- Floor Mesh Baking ---
+
+// Merges many small floor instances into a single static mesh with one section per material.
+// Source geometry is read from LOD0 render data, so in cooked builds every source mesh needs
+// bAllowCPUAccess enabled; CanBakeMesh() reports whether a mesh is usable.
+namespace FloorMeshBaker
+{
+	GEMINIDUNGEONGEN_API bool CanBakeMesh(const UStaticMesh* Mesh);
+
+	// Builds the merged mesh. bCommitMeshDescription keeps source data on the mesh so it can be
+	// saved as an asset, and cooks complex collision for it (editor bake); runtime bakes skip both,
+	// stay transient and have no collision.
+	GEMINIDUNGEONGEN_API UStaticMesh* BuildMergedMesh(UObject* Outer, FName Name, EObjectFlags Flags, TConstArrayView<FFloorBakeInstance> Instances, bool bCommitMeshDescription);
+}
@@ -6,9 +6,31 @@
 #include "GameFramework/Actor.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Data/Grid/GridData.h"
+#include "Data/Grid/GridBitMask.h"
 #include "Data/Room/RoomData.h"
+#include "DungeonGen/Rooms/RoomLayoutSolver.h"
 #include "MasterRoom.generated.h"
 
+class ADungeonManager;
+class UBoxComponent;
+class UFloorData;
+class UWallData;
+struct FRoomPreviewSolve;
+
+// How generated floor and wall instances collide on clients. Furniture always keeps its per-instance
+// collision. Dedicated servers never create HISMs: they solve the grid only and always collide against
+// the merged floor and wall boxes plus one box per furniture piece (the mesh bounds), whatever the mode.
+UENUM(BlueprintType)
+enum class ERoomCollisionMode : uint8
+{
+	// Every HISM instance keeps its mesh collision (standalone games; differs from a dedicated server)
+	PerInstance		UMETA(DisplayName = "Per Instance"),
+
+	// Floor, filler and wall HISMs have no collision; merged boxes built from the grid replace it.
+	// Matches what a dedicated server collides with, so networked rooms should use this mode.
+	Simplified		UMETA(DisplayName = "Simplified Boxes")
+};
+
 UCLASS()
 class GEMINIDUNGEONGEN_API AMasterRoom : public AActor
 {
@@ -19,16 +41,28 @@ public:
 
 	// --- Generation Parameters ---
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Generation")
+	// Replicated because floors may swap it from the manager's RoomDataPool
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = "Generation")
 	URoomData* RoomDataAsset;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated, Category = "Generation|Seed")
+	// Clients solve the same layout locally when this replicates (see OnRep_GenerationSeed)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_GenerationSeed, Category = "Generation|Seed")
 	int32 GenerationSeed = 1337;
 
 	// --- EDITOR ONLY: Generate Button ---
 	UPROPERTY(EditAnywhere, Category = "Generation|Debug")
 	bool bGenerateRoom = false; 
 
+#if WITH_EDITORONLY_DATA
+	// Re-solve the preview on a background task shortly after generation inputs are edited
+	UPROPERTY(EditAnywhere, Category = "Generation|Debug")
+	bool bAutoRegeneratePreview = true;
+
+	// Quiet time after the last edit before the preview solve starts
+	UPROPERTY(EditAnywhere, Category = "Generation|Debug", meta=(ClampMin="0.0"))
+	float PreviewDebounceSeconds = 0.3f;
+#endif
+
 	// --- Designer Override Control ---
 
 	// Array of specific 100cm cell coordinates the designer wants to force empty.
@@ -39,26 +73,178 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Generation|Designer Overrides|Floor")
 	TMap<FIntPoint, FMeshPlacementInfo> ForcedInteriorPlacements;
 
+	// --- Floor Baking ---
+
+	// Merge the floor layer into per-chunk static meshes after generation (for rooms that never change)
+	UPROPERTY(EditAnywhere, Category = "Generation|Floor Baking")
+	bool bBakeFloorAfterGeneration = false;
+
+	// Edge length of one baked floor chunk in 100cm cells
+	UPROPERTY(EditAnywhere, Category = "Generation|Floor Baking", meta=(ClampMin="1"))
+	int32 FloorBakeChunkSize = 32;
+
+	// --- Collision ---
+
+	UPROPERTY(EditAnywhere, Category = "Generation|Collision")
+	ERoomCollisionMode CollisionMode = ERoomCollisionMode::Simplified;
+
+	// Depth of the merged floor boxes below Z = 0
+	UPROPERTY(EditAnywhere, Category = "Generation|Collision", meta=(ClampMin="1.0", EditCondition="CollisionMode == ERoomCollisionMode::Simplified"))
+	float FloorCollisionThickness = 20.0f;
+
+	// Thickness of the perimeter wall boxes (centered on the grid boundary)
+	UPROPERTY(EditAnywhere, Category = "Generation|Collision", meta=(ClampMin="1.0", EditCondition="CollisionMode == ERoomCollisionMode::Simplified"))
+	float WallCollisionThickness = 20.0f;
+
+	// --- Gameplay Grid Queries (no physics, answered from the retained compact grid) ---
+
+	// Cell type under a world location; ECT_Empty outside the grid
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Queries")
+	EGridCellType GetCellTypeAtLocation(const FVector& WorldLocation) const;
+
+	// True if the cell has floor and no interior mesh on it
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Queries")
+	bool IsCellFree(const FIntPoint& Cell) const;
+
+	// Random free area of the given footprint; OutCell is its min corner, OutWorldLocation its center.
+	// 1x1: O(1), a uniform pick from the layout's free-cell index (built once per layout in O(cells)).
+	// Larger footprints: O(footprint area) expected on a mostly free floor (rejection sampling), O(1)
+	// when the room has fewer free cells than the footprint needs; a crowded room falls back to a
+	// scan of every start position, O(cells x footprint area) worst case.
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Queries")
+	bool FindRandomFreeCell(const FIntPoint& Footprint, UPARAM(ref) FRandomStream& Stream, FIntPoint& OutCell, FVector& OutWorldLocation) const;
+
+	// Nearest free cell (Euclidean, by cell center) to a world location, searching outwards ring by ring
+	// up to MaxRadius cells until no farther ring can hold a closer cell
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Queries")
+	bool FindNearestFreeCell(const FVector& WorldLocation, int32 MaxRadius, FIntPoint& OutCell, FVector& OutWorldLocation) const;
+
+	// All cells overlapping a world-space box
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Queries")
+	void GetCellsInBox(const FBox& WorldBox, TArray<FIntPoint>& OutCells) const;
+
+	// C++ iterator form of GetCellsInBox; visits only the k overlapping cells
+	void ForEachCellInBox(const FBox& WorldBox, TFunctionRef<void(const FIntPoint& Cell, EGridCellType Type)> Visitor) const;
+
+	// World <-> cell conversion that respects the actor transform
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Queries")
+	bool WorldToCell(const FVector& WorldLocation, FIntPoint& OutCell) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Dungeon|Queries")
+	FVector CellToWorld(const FIntPoint& Cell) const;
+
+	// One bit per free cell (see IsCellFree), used by the connectivity validator
+	void BuildWalkableMask(FGridBitMask& OutMask) const;
+
+	// --- Core Generation Functions ---
+
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Generation")
+	void RegenerateRoom();
+
+	// Set by ADungeonManager when it consolidates instances across rooms; null keeps per-room HISMs
+	void SetSharedInstanceManager(ADungeonManager* InManager);
+
+	// --- Lazy Materialization ---
+
+	// Set by ADungeonManager when it materializes rooms by player distance. While set, generation
+	// only solves the layout and components are taken from (and returned to) the manager's pools.
+	void SetLazyMaterialization(ADungeonManager* InManager);
+
+	// Spawns instances and collision from the retained layout (no solve)
+	void Materialize();
+
+	// Returns instances and collision to the pools; the layout and grid queries stay valid
+	void Dematerialize();
+
+	bool IsMaterialized() const { return bMaterialized; }
+
+	// False until the first solve (on clients: until the seed has replicated)
+	bool HasSolvedLayout() const { return Layout.Grid.Num() > 0; }
+
+	// World-space box of the solved grid, valid whether or not the room is materialized
+	FBox GetLayoutBounds() const;
+
 private:
-	// Internal grid array to track occupancy (used during runtime generation)
-	TArray<EGridCellType> InternalGridState;
-	
+	// Solved layout. Its packed 2-bit grid is kept after generation for gameplay queries.
+	FRoomLayout Layout;
+
+	// True if every cell of the footprint starting at Min is free (see IsCellFree)
+	bool IsAreaFree(const FIntPoint& Min, const FIntPoint& Footprint) const;
+
 	// Map to hold and manage HISM components (one HISM per unique Static Mesh)
 	TMap<UStaticMesh*, UHierarchicalInstancedStaticMeshComponent*> MeshToHISMMap;
+
+	// Owner of the shared HISMs this room's instances go to (see SetSharedInstanceManager)
+	UPROPERTY(Transient)
+	TObjectPtr<ADungeonManager> SharedInstanceManager = nullptr;
+
+	// Owner of the component pools this room draws from (see SetLazyMaterialization)
+	UPROPERTY(Transient)
+	TObjectPtr<ADungeonManager> LazyMaterializationManager = nullptr;
+
+	// True while the layout's instances and collision exist in the scene
+	bool bMaterialized = false;
+
+	// Meshes placed by the floor passes vs. the interior passes (decides what can be baked)
+	TSet<UStaticMesh*> FloorLayerMeshes;
+	TSet<UStaticMesh*> InteriorLayerMeshes;
+
+	// Merged floor chunks that replace the floor HISM instances once baked. Not transient: editor bakes
+	// are saved with the level and must still be found (and cleared) after a reload. Runtime chunks are
+	// created RF_Transient, so they load back as null entries.
+	UPROPERTY()
+	TArray<TObjectPtr<UStaticMeshComponent>> BakedFloorComponents;
+
+	// Merged meshes of the last runtime bake and the floor meshes they replace. Kept with the layout so
+	// rematerializing only re-creates components; reset whenever a new layout is solved.
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UStaticMesh>> CachedBakedFloorMeshes;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UStaticMesh>> CachedBakedSourceMeshes;
+
+	// Merged floor and wall colliders (Simplified collision mode), reused across regenerations
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UBoxComponent>> CollisionBoxes;
 	
 protected:
-
+	virtual void Destroyed() override;
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 	virtual void PostLoad() override;
-#endif
-	
-	// --- Core Generation Functions ---
 
-	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Generation")
-	void RegenerateRoom();
+	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
+
+	// Regenerates the room and bakes its floor layer into static mesh assets under /Game/DungeonGen/Baked
+	UFUNCTION(CallInEditor, Category = "Generation|Floor Baking")
+	void BakeFloorToAssets();
+
+	// --- Background Preview ---
+
+	// Debounced: every call restarts the timer, so only the last edit of a burst is solved
+	void RequestPreviewRegeneration();
+	void StartPreviewSolve();
+	void ApplyPreviewSolve(const TSharedRef<FRoomPreviewSolve>& PreviewSolve);
 
+	// bWait blocks until the task has stopped reading the data assets
+	void CancelPreviewSolve(bool bWait);
+
+	// Edits to the room's data assets (grid size, pools) also refresh the preview. One static
+	// registration serves every room; edits to anything but room, floor or wall data stop there.
+	bool IsPreviewSource(const UObject* Object) const;
+	static void RegisterPreviewRoom(AMasterRoom* Room);
+	static void UnregisterPreviewRoom(AMasterRoom* Room);
+	static void OnPreObjectPropertyChanged(UObject* Object, const class FEditPropertyChain& PropertyChain);
+	static void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+#endif
+
+#if WITH_EDITORONLY_DATA
+	FTimerHandle PreviewDebounceHandle;
+	TSharedPtr<FRoomPreviewSolve> ActivePreviewSolve;
+#endif
+	
 	// Logic for clearing and resetting all HISM components
 	void ClearAndResetComponents();
 	UHierarchicalInstancedStaticMeshComponent* GetOrCreateHISM(UStaticMesh* Mesh);
@@ -66,16 +252,37 @@ protected:
 	// New helper for easy world coordinate translation
 	FVector GetCellCenterWorldLocation(int32 X, int32 Y) const;
 
-	// Floor and Interior Logic
-	void ExecuteForcedPlacements(FRandomStream& Stream);
-	void GenerateFloorAndInterior();
+	// Spawns the solved layout's placements into HISM components
+	void ApplyLayout();
 
-	// 1D wall placement logic using WallDataAsset
-	void GenerateWallsAndDoors();
-	
-	const FMeshPlacementInfo* SelectWeightedMesh(const TArray<FMeshPlacementInfo>& MeshPool, FRandomStream& Stream);
+	// Everything after the solve: components, collision, baking, bounds and debug drawing
+	void FinishGeneration(const UWallData* WallData, bool bRerunConstructionScripts);
+
+	// Components, collision, baking and bounds for the current layout (FinishGeneration and Materialize)
+	void MaterializeLayout(const UWallData* WallData);
+
+	// Per-room HISMs go back to the manager's pool when lazily materialized, otherwise they are destroyed
+	void ReleaseInstancedComponents();
+	void ReleaseCollisionBox(UBoxComponent* BoxComponent);
+
+	// Floor baking: merges floor HISM instances into per-chunk static mesh components
+	void BakeFloorLayer(bool bSaveAsAssets);
+	void AddBakedFloorComponent(UStaticMesh* MergedMesh, bool bSaveAsAssets);
+	void ClearBakedFloor();
+	void ResetFloorBakeCache();
+
+	// Simplified collision: floor and wall boxes from the solved grid, plus one box per furniture
+	// placement from its mesh bounds when the furniture has no HISM to collide with (dedicated server)
+	void BuildSimplifiedCollision(float WallHeight, bool bFurnitureBoxes);
+	void ClearSimplifiedCollision();
 	
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION()
+	void OnRep_GenerationSeed();
+
+	// Solve and finish generation without the authority check (RegenerateRoom and client seed replication)
+	void GenerateLayout(bool bRerunConstructionScripts);
 	
 	// Helper function for drawing the debug grid in the editor
 	void DrawDebugGrid();
@@ -0,0 +1,30 @@
+// RoomCollisionBuilder.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+struct FCompactRoomGrid;
+
+// --- Room Collision Simplification ---
+
+// Builds a handful of room-local boxes that stand in for per-instance floor and wall collision.
+// Floor cells are greedily merged into rectangles; each straight perimeter wall run gets one box,
+// split at doorway cells. Pure grid math, so it runs the same on clients and dedicated servers.
+// Outputs and temporaries live on the caller's FMemMark; no inner mark is pushed, so the outputs can
+// keep growing while the builder works.
+namespace RoomCollisionBuilder
+{
+	using FRectArray = TArray<FIntRect, TMemStackAllocator<>>;
+	using FBoxArray = TArray<FBox, TMemStackAllocator<>>;
+
+	// Greedy rectangle cover of the cells IsSolid accepts: grow right, then down, row-major
+	GEMINIDUNGEONGEN_API void BuildRects(const FIntPoint& Size, TFunctionRef<bool(int32 Index)> IsSolid, FRectArray& OutRects);
+
+	// BuildRects over floor and doorway cells (forced empty cells, reserved as ECT_Wall, are never covered)
+	GEMINIDUNGEONGEN_API void BuildFloorRects(const FCompactRoomGrid& Grid, FRectArray& OutRects);
+
+	// Floor slabs (top at Z = 0) plus perimeter wall boxes (skipped when WallHeight <= 0)
+	GEMINIDUNGEONGEN_API void BuildCollisionBoxes(const FCompactRoomGrid& Grid, float FloorThickness, float WallHeight, float WallThickness, FBoxArray& OutBoxes);
+}
@@ -0,0 +1,161 @@
+﻿// RoomLayoutSolver.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "Data/Grid/GridData.h"
+#include "Data/Grid/CompactRoomGrid.h"
+#include "Data/Grid/GridBitMask.h"
+#include "Data/Grid/MaxRectsPacker.h"
+#include "DungeonGen/Rooms/WaveFunctionCollapseSolver.h"
+#include <atomic>
+
+class URoomData;
+class UFloorData;
+class UWallData;
+
+// Which generation pass produced a placement
+enum class ERoomLayer : uint8
+{
+	Floor,
+	Interior,
+	Wall
+};
+
+// One mesh instance produced by the solver (transform is room-local)
+struct FRoomMeshPlacement
+{
+	int32 MeshIndex = INDEX_NONE; // Index into FRoomLayout::Meshes
+	FTransform Transform;
+	ERoomLayer Layer = ERoomLayer::Floor;
+};
+
+// --- Room Layout ---
+
+// The complete result of a room solve: occupancy grid plus every mesh instance to spawn.
+// Contains no actors or components, so it can be produced headless or off the game thread.
+struct GEMINIDUNGEONGEN_API FRoomLayout
+{
+	// Packed 2-bit cell types
+	FCompactRoomGrid Grid;
+
+	// Cells covered by interior meshes (forced placements and packed furniture)
+	TBitArray<> InteriorOccupancy;
+
+	// Unique meshes referenced by Placements
+	TArray<TSoftObjectPtr<UStaticMesh>> Meshes;
+	TArray<FRoomMeshPlacement> Placements;
+
+	// Cells filled by DefaultFillerTile in the gap filling pass
+	int32 NumFillerTiles = 0;
+
+	// Floor cells with no interior mesh on them (see IsCellFree), counted once at the end of the solve
+	int32 NumFreeCells = 0;
+
+	// Clears all placements and sizes the grid for a new solve (allocations are kept)
+	void Reset(const FIntPoint& GridSize);
+	void Empty();
+
+	int32 AddMesh(const TSoftObjectPtr<UStaticMesh>& Mesh);
+
+	// Floor with no interior mesh on it
+	bool IsCellFree(int32 Index) const;
+	void UpdateNumFreeCells();
+	void BuildWalkableMask(FGridBitMask& OutMask) const;
+
+	// Grid indices of every free cell, built by one O(cells) scan on first use and kept until the
+	// next Reset. Costs 4 bytes per free cell, so only layouts that are queried pay for it.
+	const TArray<int32>& GetFreeCellIndices() const;
+
+private:
+	mutable TArray<int32> FreeCellIndices;
+	mutable bool bFreeCellIndicesBuilt = false;
+};
+
+// Everything a solve reads. Data assets must already be loaded.
+struct FRoomSolverInput
+{
+	const URoomData* RoomData = nullptr;
+	const UFloorData* FloorData = nullptr;
+	const UWallData* WallData = nullptr;
+	int32 Seed = 0;
+
+	TConstArrayView<FIntPoint> ForcedEmptyFloorCells;
+	const TMap<FIntPoint, FMeshPlacementInfo>* ForcedInteriorPlacements = nullptr;
+
+	// Fill the grid and interior occupancy, but record only the furniture placements (dedicated servers
+	// need them for collision; floor, filler and wall instances are skipped).
+	// Random consumption is unchanged, so the grid matches the one clients solve.
+	bool bGridOnly = false;
+
+	// Optional: set from another thread to abandon a background solve (Solve then returns false)
+	const std::atomic<bool>* CancelFlag = nullptr;
+};
+
+// --- Room Layout Solver ---
+
+// Pure layout solver behind AMasterRoom::RegenerateRoom. Runs the same passes in the same
+// random order, but only writes an FRoomLayout, so it is safe to run on worker threads.
+class GEMINIDUNGEONGEN_API FRoomLayoutSolver
+{
+public:
+	// False if there is no room data or the solve was cancelled (the layout is then incomplete)
+	bool Solve(const FRoomSolverInput& InInput, FRoomLayout& OutLayout);
+
+	// Solver shared by everything generated on the calling thread. Its scratch buffers (WFC domains and
+	// trail, packer masks) then exist once per thread rather than once per room.
+	// Lifetime: a thread_local destroyed at thread exit, freeing through GMalloc, which the engine never
+	// tears down. Meant for the game thread; worker loops (the seed miner) own one solver per worker.
+	static FRoomLayoutSolver& GetForCurrentThread();
+
+	static const FMeshPlacementInfo* SelectWeightedMesh(const TArray<FMeshPlacementInfo>& MeshPool, FRandomStream& Stream);
+
+	// Wraps GMalloc in a pass-through proxy that counts the heap allocations (Malloc/Realloc) each
+	// thread makes while inside Solve. Non-shipping builds only (returns false otherwise). Call once on
+	// the game thread before any other thread solves; the proxy is never removed.
+	static bool EnableAllocationCounting();
+
+	// Heap allocations made by the last Solve on this solver, including its FMemStack pages, or
+	// INDEX_NONE when counting is off. A warm solver (same grid size) should report 0.
+	int32 GetNumHeapAllocationsInLastSolve() const { return NumHeapAllocationsInLastSolve; }
+
+private:
+	// Rotated footprint for a yaw from AllowedRotations
+	static FIntPoint GetRotatedFootprint(const FMeshPlacementInfo& Info, float YawRotation);
+
+	FORCEINLINE bool IsCancelled() const
+	{
+		return Input->CancelFlag && Input->CancelFlag->load(std::memory_order_relaxed);
+	}
+
+	void AddPlacement(const TSoftObjectPtr<UStaticMesh>& Mesh, const FIntPoint& Start, const FIntPoint& Footprint, float YawRotation, ERoomLayer Layer);
+
+	// Designer overrides: forced empty cells and forced placements (Pass 0)
+	void ExecuteForcedPlacements();
+
+	// Weighted floor tiles with edge constraint (Pass 1) and gap filling (Pass 2)
+	void GenerateFloor();
+
+	// Pass 1 alternative for EFloorSolverMode::WaveFunctionCollapse; false falls back to the weighted pass
+	bool GenerateFloorWFC();
+
+	// MaxRects packing pass for large furniture from InteriorMeshPool (Pass 3)
+	void GenerateInteriorFurniture();
+
+	// Corners now; door reservation and 1D wall packing next
+	void GenerateWallsAndDoors();
+
+	const FRoomSolverInput* Input = nullptr;
+	FRoomLayout* Layout = nullptr;
+	FIntPoint GridSize = FIntPoint::ZeroValue;
+	FRandomStream Stream;
+	FMaxRectsPacker Packer;
+	FWaveFunctionCollapseSolver WFCSolver;
+
+	// Buffers reused by every solve; they grow to the largest grid this solver has seen
+	TBitArray<> PackerBlockedCells;
+	TArray<uint64> WFCDomains;
+
+	int32 NumHeapAllocationsInLastSolve = INDEX_NONE;
+};
@@ -0,0 +1,79 @@
+// WaveFunctionCollapseSolver.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include <atomic>
+
+// --- Wave Function Collapse Solver ---
+
+// Grid WFC over up to 64 tiles. Each cell's candidate set is one uint64 (bit t = tile t), so
+// propagation is a handful of word ANDs per neighbour. The lowest-entropy cell comes from a
+// lazily invalidated heap. Every domain change is recorded on a trail, so a contradiction
+// undoes only the last decision, bans that choice and carries on (bounded by MaxBacktracks).
+class GEMINIDUNGEONGEN_API FWaveFunctionCollapseSolver
+{
+public:
+	static constexpr int32 MaxTiles = 64;
+
+	// Weights: one per tile. Compatible[t]: tiles allowed on any side of tile t (must be symmetric).
+	// InOutDomains: initial candidate mask per cell (row-major, 0 = not part of the solve and
+	// unconstrained by it). On success every active cell holds exactly one bit.
+	bool Solve(const FIntPoint& Size, TConstArrayView<float> Weights, TConstArrayView<uint64> Compatible,
+		TArray<uint64>& InOutDomains, FRandomStream& Stream, int32 MaxBacktracks, const std::atomic<bool>* CancelFlag = nullptr);
+
+	// Decisions undone by the last Solve
+	int32 GetNumBacktracks() const { return NumBacktracks; }
+
+private:
+	struct FTrailEntry
+	{
+		int32 Cell;
+		uint64 OldDomain;
+	};
+
+	struct FDecision
+	{
+		int32 TrailMark;
+		int32 Cell;
+		int32 Tile;
+	};
+
+	struct FHeapEntry
+	{
+		float Entropy;
+		int32 Cell;
+		uint32 Version;
+
+		bool operator<(const FHeapEntry& Other) const { return Entropy < Other.Entropy; }
+	};
+
+	// Records the old domain on the trail and queues the cell for propagation
+	void SetDomain(int32 Cell, uint64 NewDomain);
+	void UndoTo(int32 TrailMark);
+
+	// Narrows neighbours until nothing changes; false on a contradiction (an emptied domain)
+	bool Propagate();
+
+	void PushEntropy(int32 Cell);
+	int32 PopLowestEntropy();
+	int32 PickWeightedTile(uint64 Domain);
+
+	FIntPoint Size = FIntPoint::ZeroValue;
+	uint64* Domains = nullptr;
+	const uint64* CompatibleMasks = nullptr;
+	FRandomStream* RandomStream = nullptr;
+	int32 NumBacktracks = 0;
+
+	// Per tile weight and weight * log(weight), for entropy
+	float TileWeights[MaxTiles];
+	float TileWeightLogWeights[MaxTiles];
+
+	// Scratch, kept between solves
+	TArray<uint32> Versions;
+	TArray<FTrailEntry> Trail;
+	TArray<FDecision> Decisions;
+	TArray<FHeapEntry> Heap;
+	TArray<int32> PropagationStack;
+};